@@ -0,0 +1,348 @@
+#define _XOPEN_SOURCE 700
+#include "led_controller.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Defaults, overridable with --warmup=N and --repetitions=N */
+#define BENCH_DEFAULT_WARMUP 20
+#define BENCH_DEFAULT_REPETITIONS 200
+#define BENCH_DEFAULT_FONT_PATH "workspace/assets/retro_gaming.ttf"
+
+/* Runs iterations operations of a benchmark. */
+typedef void (*BenchmarkFunction)(void *context, int iterations);
+
+/* A named benchmark and how many operations to time per repetition.
+ *
+ * Fast operations are batched so a repetition is well above the clock resolution,
+ * results are always reported per operation.
+ */
+typedef struct
+{
+    const char *name;
+    BenchmarkFunction function;
+    void *context;
+    int iterations_per_repetition;
+    /* Input size of one operation, when set throughput is reported as well */
+    size_t bytes_per_operation;
+} Benchmark;
+
+/* Everything create_text_texture needs. */
+typedef struct
+{
+    SDL_Renderer *renderer;
+    TTF_Font *font;
+} TextTextureContext;
+
+/* Input for parse_settings_buffer, the file save_settings writes. */
+typedef struct
+{
+    char text[1024];
+    size_t length;
+    AppState *app_state;
+} SettingsParseContext;
+
+/* Results are written into this so the compiler can't discard the work. */
+static volatile uintptr_t benchmark_sink;
+
+static uint64_t bench_now_nanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static int compare_doubles(const void *left, const void *right)
+{
+    double left_value = *(const double *)left;
+    double right_value = *(const double *)right;
+    return (left_value > right_value) - (left_value < right_value);
+}
+
+static void run_benchmark(const Benchmark *benchmark, int warmup, int repetitions, FILE *results)
+{
+    double *samples = malloc(sizeof(double) * repetitions);
+    if (samples == NULL)
+    {
+        perror("malloc");
+        return;
+    }
+
+    for (int repetition = 0; repetition < warmup; repetition++)
+    {
+        benchmark->function(benchmark->context, benchmark->iterations_per_repetition);
+    }
+
+    for (int repetition = 0; repetition < repetitions; repetition++)
+    {
+        uint64_t start = bench_now_nanos();
+        benchmark->function(benchmark->context, benchmark->iterations_per_repetition);
+        samples[repetition] = (double)(bench_now_nanos() - start) / benchmark->iterations_per_repetition;
+    }
+
+    qsort(samples, repetitions, sizeof(double), compare_doubles);
+    double median = samples[repetitions / 2];
+    int p99_index = (repetitions * 99 + 99) / 100 - 1;
+    double p99 = samples[p99_index < repetitions ? p99_index : repetitions - 1];
+
+    /* One JSON object per line on stdout for tooling, a readable table on stderr. */
+    /* Bytes per nanosecond is the same as GB/s, scale to MB/s. */
+    double megabytes_per_second = median > 0 ? benchmark->bytes_per_operation / median * 1000.0 : 0.0;
+    fprintf(results, "{\"benchmark\":\"%s\",\"repetitions\":%d,\"iterations\":%d,\"median_ns\":%.1f,\"p99_ns\":%.1f,\"min_ns\":%.1f,\"max_ns\":%.1f",
+            benchmark->name, repetitions, benchmark->iterations_per_repetition, median, p99, samples[0], samples[repetitions - 1]);
+    if (benchmark->bytes_per_operation > 0)
+    {
+        fprintf(results, ",\"bytes\":%zu,\"median_mb_per_s\":%.1f", benchmark->bytes_per_operation, megabytes_per_second);
+    }
+    fprintf(results, "}\n");
+    fprintf(stderr, "%-28s median %12.1f ns   p99 %12.1f ns", benchmark->name, median, p99);
+    if (benchmark->bytes_per_operation > 0)
+    {
+        fprintf(stderr, "   %9.1f MB/s", megabytes_per_second);
+    }
+    fprintf(stderr, "\n");
+    free(samples);
+}
+
+static void bench_update_leds(void *context, int iterations)
+{
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        update_leds((AppState *)context);
+    }
+}
+
+static void bench_save_settings(void *context, int iterations)
+{
+    AppState *app_state = context;
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        /* Change a value every time, identical settings are never written. */
+        app_state->led_settings[LED_FRONT].brightness ^= 1;
+        save_settings(app_state);
+    }
+}
+
+static void bench_save_settings_unchanged(void *context, int iterations)
+{
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        save_settings((AppState *)context);
+    }
+}
+
+static void bench_read_settings(void *context, int iterations)
+{
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        read_settings((AppState *)context);
+    }
+}
+
+static void bench_parse_settings_buffer(void *context, int iterations)
+{
+    SettingsParseContext *parse_context = context;
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        benchmark_sink = parse_settings_buffer(parse_context->text, parse_context->length, parse_context->app_state);
+    }
+}
+
+static void bench_create_text_texture(void *context, int iterations)
+{
+    TextTextureContext *text_context = context;
+    SDL_Color color = {255, 239, 186, 255};
+    SDL_Color shadow = {0, 0, 0, 128};
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        SDL_Texture *texture = create_text_texture(text_context->renderer, text_context->font, &color, &shadow, "<  Brightness: 6  >");
+        SDL_DestroyTexture(texture);
+    }
+}
+
+static void bench_next_color(void *context, int iterations)
+{
+    (void)context;
+    uint32_t color = 0xFF0000;
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        color = next_color(color, COLOR_CYLCE_INCREMENT);
+    }
+    benchmark_sink = color;
+}
+
+static void bench_color_to_string(void *context, int iterations)
+{
+    (void)context;
+    /* Mix of named colors (switch hit) and extended colors (hex formatting). */
+    static const uint32_t sample_colors[] = {0xFF0000, 0xFF8000, 0x123456, 0xFFFFFF, 0x00FF40, 0x808000, 0xFF30FF, 0x0080FF};
+    const int sample_count = sizeof(sample_colors) / sizeof(sample_colors[0]);
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        benchmark_sink = (uintptr_t)color_to_string(sample_colors[iteration % sample_count]);
+    }
+}
+
+static void bench_sdl_event_to_input_type(void *context, int iterations)
+{
+    SDL_Event *events = context;
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        benchmark_sink = sdl_event_to_input_type(&events[iteration % 4], false);
+    }
+}
+
+static void bench_is_supported_input_event(void *context, int iterations)
+{
+    (void)context;
+    static const Uint32 event_types[] = {SDL_KEYDOWN, SDL_MOUSEMOTION, SDL_CONTROLLERBUTTONDOWN, SDL_WINDOWEVENT,
+                                         SDL_QUIT, SDL_FINGERMOTION, SDL_CONTROLLERAXISMOTION, SDL_MOUSEBUTTONDOWN};
+    const int event_type_count = sizeof(event_types) / sizeof(event_types[0]);
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        benchmark_sink = is_supported_input_event(event_types[iteration % event_type_count]);
+    }
+}
+
+static int remove_path(const char *path, const struct stat *status, int type_flag, struct FTW *ftw_buffer)
+{
+    (void)status;
+    (void)type_flag;
+    (void)ftw_buffer;
+    return remove(path);
+}
+
+int main(int argc, char *argv[])
+{
+    int warmup = BENCH_DEFAULT_WARMUP;
+    int repetitions = BENCH_DEFAULT_REPETITIONS;
+    const char *font_path = BENCH_DEFAULT_FONT_PATH;
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        if (strncmp(argv[arg_index], "--warmup=", strlen("--warmup=")) == 0)
+        {
+            warmup = clamp(atoi(argv[arg_index] + strlen("--warmup=")), 0, 1000000);
+        }
+        else if (strncmp(argv[arg_index], "--repetitions=", strlen("--repetitions=")) == 0)
+        {
+            repetitions = clamp(atoi(argv[arg_index] + strlen("--repetitions=")), 1, 1000000);
+        }
+        else if (strncmp(argv[arg_index], "--font=", strlen("--font=")) == 0)
+        {
+            font_path = argv[arg_index] + strlen("--font=");
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--warmup=N] [--repetitions=N] [--font=path]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* The core logs to stdout, keep results on the original stdout and send the logging to /dev/null. */
+    FILE *results = fdopen(dup(STDOUT_FILENO), "w");
+    if (results == NULL || freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("redirect stdout");
+        return 1;
+    }
+    SDL_LogSetOutputFunction(NULL, NULL);
+
+    /* Load the font before leaving the project directory. */
+    CoreSDLComponents core_components = {0};
+    core_components.window_width = WINDOW_WIDTH;
+    core_components.window_height = WINDOW_HEIGHT;
+    core_components.headless = true;
+    if (initialize_sdl_core(&core_components, WINDOW_TITLE) != 0 || TTF_Init() == -1)
+    {
+        fprintf(stderr, "Failed to initialize headless SDL\n");
+        return 1;
+    }
+    TextTextureContext text_context = {core_components.renderer, TTF_OpenFont(font_path, 32)};
+    if (text_context.font == NULL)
+    {
+        fprintf(stderr, "Failed to load font %s: %s\n", font_path, TTF_GetError());
+        return 1;
+    }
+
+    /* Settings and LED files go to a scratch directory, never the real sysfs tree. */
+    char scratch_directory[] = "/tmp/led_controller_bench.XXXXXX";
+    char fake_sys_directory[STRING_LENGTH];
+    if (mkdtemp(scratch_directory) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(fake_sys_directory, sizeof(fake_sys_directory), "%s/led_anim", scratch_directory);
+    if (mkdir(fake_sys_directory, 0755) != 0 || chdir(scratch_directory) != 0)
+    {
+        perror("scratch directory");
+        return 1;
+    }
+    led_sys_file_path = fake_sys_directory;
+
+    AppState app_state = {0};
+    app_state.should_enable_low_battery_indication = true;
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        app_state.led_settings[led] = (LedSettings){.brightness = 60, .effect = STATIC, .color = 0xFF8000, .duration = 500};
+    }
+    save_settings(&app_state);
+
+    SettingsParseContext parse_context = {.app_state = &app_state};
+    FILE *settings_file = fopen(settings_file_path, "r");
+    if (settings_file == NULL)
+    {
+        perror("fopen");
+        return 1;
+    }
+    parse_context.length = fread(parse_context.text, 1, sizeof(parse_context.text), settings_file);
+    fclose(settings_file);
+
+    SDL_Event events[4];
+    memset(events, 0, sizeof(events));
+    events[0].type = SDL_KEYDOWN;
+    events[0].key.keysym.sym = SDLK_RIGHT;
+    events[1].type = SDL_CONTROLLERBUTTONDOWN;
+    events[1].cbutton.button = SDL_CONTROLLER_BUTTON_DPAD_LEFT;
+    events[2].type = SDL_MOUSEBUTTONDOWN;
+    events[2].button.button = SDL_BUTTON_LEFT;
+    events[3].type = SDL_MOUSEMOTION;
+
+    Benchmark benchmarks[] = {
+        {"update_leds", bench_update_leds, &app_state, 1, 0},
+        {"save_settings", bench_save_settings, &app_state, 1, 0},
+        {"save_settings_unchanged", bench_save_settings_unchanged, &app_state, 1000, 0},
+        {"read_settings", bench_read_settings, &app_state, 1, 0},
+        {"parse_settings_buffer", bench_parse_settings_buffer, &parse_context, 1000, parse_context.length},
+        {"create_text_texture", bench_create_text_texture, &text_context, 1, 0},
+        {"next_color", bench_next_color, NULL, 10000, 0},
+        {"color_to_string", bench_color_to_string, NULL, 10000, 0},
+        {"sdl_event_to_input_type", bench_sdl_event_to_input_type, events, 10000, 0},
+        {"is_supported_input_event", bench_is_supported_input_event, NULL, 10000, 0},
+    };
+    const int benchmark_count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    struct utsname system_name;
+    uname(&system_name);
+    fprintf(results, "{\"suite\":\"led_controller\",\"machine\":\"%s\",\"timestamp\":%ld,\"warmup\":%d,\"repetitions\":%d}\n",
+            system_name.machine, (long)time(NULL), warmup, repetitions);
+    for (int benchmark_index = 0; benchmark_index < benchmark_count; benchmark_index++)
+    {
+        run_benchmark(&benchmarks[benchmark_index], warmup, repetitions, results);
+    }
+
+    TTF_CloseFont(text_context.font);
+    TTF_Quit();
+    free_sdl_core(&core_components);
+    SDL_Quit();
+    nftw(scratch_directory, remove_path, 8, FTW_DEPTH | FTW_PHYS);
+    fclose(results);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "led_core.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* libFuzzer target for parse_settings_buffer.
+ *
+ * Besides memory errors (run with AddressSanitizer) this aborts if a parsed
+ * value escapes the clamp rules. Seed inputs live in workspace/fuzz/corpus.
+ * Build with -DFUZZ_REPLAY_MAIN to replay files without libFuzzer.
+ */
+
+static void check_settings_in_range(const AppState *app_state)
+{
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        const LedSettings *settings = &app_state->led_settings[led];
+        if (settings->brightness < 0 || settings->brightness > MAX_BRIGHTNESS ||
+            settings->color > 0xFFFFFF ||
+            settings->duration < 0 || settings->duration > MAX_DURATION ||
+            (int)settings->effect < 0 || settings->effect >= ANIMATION_EFFECT_COUNT)
+        {
+            fprintf(stderr, "LED %d settings out of range\n", led);
+            abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    AppState app_state = {0};
+    parse_settings_buffer((const char *)data, size, &app_state);
+    check_settings_in_range(&app_state);
+    return 0;
+}
+
+#ifdef FUZZ_REPLAY_MAIN
+int main(int argc, char *argv[])
+{
+    static uint8_t buffer[1 << 20];
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        FILE *file = fopen(argv[arg_index], "rb");
+        if (!file)
+        {
+            perror("fopen");
+            return 1;
+        }
+        size_t size = fread(buffer, 1, sizeof(buffer), file);
+        fclose(file);
+        LLVMFuzzerTestOneInput(buffer, size);
+    }
+    printf("Replayed %d inputs\n", argc - 1);
+    return 0;
+}
+#endif
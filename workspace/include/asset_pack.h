@@ -0,0 +1,71 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Images predecoded by tools/pack_assets.c (make asset_pack), loaded with open_asset_pack */
+#define ASSET_PACK_PATH "assets/images.pack"
+/* "LDPK" read as a little endian uint32_t */
+#define ASSET_PACK_MAGIC 0x4B50444Cu
+#define ASSET_PACK_VERSION 2
+/* Pixel data starts on a page boundary so it can be used straight from the mapping */
+#define ASSET_PACK_ALIGNMENT 4096
+#define ASSET_PACK_NAME_LENGTH 64
+
+/* How an image uses its alpha channel, decides which reduced texture formats can hold it */
+typedef enum
+{
+  /* Every pixel is fully opaque, uploaded without alpha */
+  IMAGE_ALPHA_OPAQUE,
+  /* Pixels are either fully opaque or fully transparent */
+  IMAGE_ALPHA_BINARY,
+  /* Partially transparent pixels, needs a full 8 bit alpha channel */
+  IMAGE_ALPHA_BLENDED,
+} ImageAlphaType;
+
+/*
+ * File layout:
+ *  AssetPackHeader
+ *  AssetPackEntry[entry_count]
+ *  pixel data for each entry, at its ASSET_PACK_ALIGNMENT aligned offset
+ *
+ * Values are stored in the byte order of the machine that built the pack,
+ * which matches the device for the arm64 toolchain builds.
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+} AssetPackHeader;
+
+typedef struct
+{
+  /* Image file name, i.e background.png */
+  char name[ASSET_PACK_NAME_LENGTH];
+  /* SDL_PIXELFORMAT_* value of the stored pixels */
+  uint32_t pixel_format;
+  uint32_t width;
+  uint32_t height;
+  /* Bytes per row, rows are tightly packed */
+  uint32_t pitch;
+  /* ImageAlphaType of the pixels, measured when the pack was built */
+  uint32_t alpha_type;
+  uint32_t reserved;
+  /* Start of the pixels from the beginning of the file */
+  uint64_t offset;
+  uint64_t size;
+} AssetPackEntry;
+
+/* A pack mapped into memory, entries point into the mapping. */
+typedef struct
+{
+  const unsigned char *data;
+  size_t size;
+  const AssetPackEntry *entries;
+  uint32_t entry_count;
+} AssetPack;
+
+#endif
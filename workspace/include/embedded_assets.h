@@ -0,0 +1,31 @@
+#ifndef EMBEDDED_ASSETS_H
+#define EMBEDDED_ASSETS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Check if this binary was built with its assets embedded.
+ *
+ * Returns:
+ *      true for EMBED_ASSETS=1 builds
+ */
+bool are_assets_embedded(void);
+
+/**
+ * Look up the embedded copy of an asset.
+ *
+ *  The data lives in the executable's read-only data, wrap it with
+ *  SDL_RWFromConstMem to load it without touching the filesystem.
+ *
+ * Parameters:
+ *      path - path the asset is normally loaded from, i.e BACKGROUND_IMAGE_PATH
+ *      data - set to the embedded bytes
+ *      size - set to the number of embedded bytes
+ *
+ * Returns:
+ *      true if the asset is embedded (always false without EMBED_ASSETS)
+ */
+bool find_embedded_asset(const char *path, const unsigned char **data, size_t *size);
+
+#endif
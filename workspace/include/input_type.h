@@ -0,0 +1,34 @@
+#ifndef INPUT_TYPE_H
+#define INPUT_TYPE_H
+
+/* Used to convert SDL inputs to a common input definition.
+ *
+ * Useful in the case of accepting both keyboard and controller inputs.
+ */
+typedef enum
+{
+    UNKNOWN,
+    START,
+    SELECT,
+    MENU,
+    POWER,
+    DPAD_LEFT,
+    DPAD_RIGHT,
+    DPAD_UP,
+    DPAD_DOWN,
+    A,
+    B,
+    X,
+    Y,
+    L1,
+    R1,
+    L2,
+    R2,
+    L3,
+    R3,
+    /* One fine step of a continuous setting (hue, brightness), sent by the left stick */
+    SWEEP_LEFT,
+    SWEEP_RIGHT,
+} InputType;
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef INSTALLER_H
+#define INSTALLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Directory the daemon and its settings are installed to */
+#define INSTALL_SERVICE_DIRECTORY "/etc/led_controller"
+/* Installed sizes, mtimes and content hashes, one "destination size seconds nanoseconds hash" line per copied file */
+#define INSTALLED_MANIFEST_FILE INSTALL_SERVICE_DIRECTORY "/install.manifest"
+/* Stock low battery script the custom one replaces, restored from STOCK_LOW_BATTERY_BACKUP */
+#define STOCK_LOW_BATTERY_SCRIPT "/usr/trimui/bin/low_battery_led.sh"
+#define STOCK_LOW_BATTERY_BACKUP STOCK_LOW_BATTERY_SCRIPT ".bak"
+/* Most copied files the manifest file records */
+#define INSTALL_MANIFEST_CAPACITY 16
+
+typedef enum
+{
+  /* Copy source over destination when its content changed */
+  INSTALL_COPY,
+  /* Point destination at source, which is the link target */
+  INSTALL_SYMLINK,
+} InstallAction;
+
+typedef enum
+{
+  /* Always installed */
+  INSTALL_ALWAYS,
+  /* Installed only with low battery indication enabled, removed otherwise */
+  INSTALL_IF_LOW_BATTERY_INDICATION,
+} InstallCondition;
+
+/* One step of the install, uninstall runs the same table backwards. */
+typedef struct
+{
+  InstallAction action;
+  InstallCondition condition;
+  /* Path relative to the pak for copies (NULL means settings_file_path), link target for symlinks */
+  const char *source;
+  const char *destination;
+  mode_t mode;
+  /* Move an existing regular file here before replacing it, restored on removal (optional) */
+  const char *backup;
+} InstallEntry;
+
+/* What a previous install recorded about one copied file. */
+typedef struct
+{
+  char destination[256];
+  long long size;
+  long long modified_seconds;
+  long modified_nanoseconds;
+  uint64_t content_hash;
+} InstalledFileRecord;
+
+/**
+ * Install the settings daemon, its settings and the low battery script.
+ *
+ *  Walks the install manifest. Copies are staged next to their destination
+ *  with copy_file_range (sendfile or read/write where unsupported), synced
+ *  and renamed into place, and only happen when the source's content hash
+ *  differs from the installed one. Sources whose size and mtime match the
+ *  manifest file aren't even read, so a repeat install costs a few stats.
+ *
+ * Parameters:
+ *      should_enable_low_battery_indication - install (true) or remove (false) the custom low battery script
+ *
+ * Returns:
+ *      0 on success, 1 if any step failed (the next install retries it)
+ */
+int install_daemon(bool should_enable_low_battery_indication);
+
+/**
+ * Remove everything install_daemon installed.
+ *
+ *  Replays the install manifest in reverse, restores the stock low battery
+ *  script and makes the LED system files writable again.
+ *
+ * Returns:
+ *      0 on success, 1 if anything couldn't be removed
+ */
+int uninstall_daemon(void);
+
+#endif
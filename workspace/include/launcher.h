@@ -0,0 +1,64 @@
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Log written next to the binary by --launch, same file launch.sh appended to. */
+#define LAUNCHER_LOG_FILE "led_controller.log"
+
+/* Exit code teardown returns when the user picked Uninstall from the menu. */
+#define UNINSTALL_EXIT_CODE 66
+
+/* stdio buffer for the launch log, a whole session normally fits without a flush. */
+#define LAUNCHER_LOG_BUFFER_SIZE 8192
+
+/**
+ * Do what launch.sh did before starting the app, without forking.
+ *
+ *  Changes into the binary's directory, opens the launch log (stderr is
+ *  redirected into it) and makes the LED system files writable with chmod(2).
+ *
+ * Parameters:
+ *      program_path - argv[0], used to find the pak directory
+ *
+ * Returns:
+ *      0 on success, 1 if the log or the LED files couldn't be set up
+ */
+int launcher_start(const char *program_path);
+
+/**
+ * Append a timestamped line to the launch log.
+ *
+ *  Writes to stdout when launcher_start hasn't opened the log. Lines stay in
+ *  the stdio buffer until launcher_finish, the timestamp is only reformatted
+ *  when the second changes.
+ *
+ * Parameters:
+ *      format - printf style format string, a newline is appended
+ */
+void launcher_log(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * Milliseconds since the kernel started this process, includes dynamic loading.
+ *
+ * Returns:
+ *      elapsed time, or 0 if /proc/self/stat couldn't be read
+ */
+uint32_t launcher_millis_since_exec(void);
+
+/**
+ * Do what launch.sh did after the app returned.
+ *
+ *  Turns the LEDs off when the user uninstalled, locks the LED system files
+ *  again and flushes the log.
+ *
+ * Parameters:
+ *      exit_code - value teardown returned
+ *
+ * Returns:
+ *      0, launch.sh always exited cleanly
+ */
+int launcher_finish(int exit_code);
+
+#endif
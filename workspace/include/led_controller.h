@@ -6,91 +6,178 @@
 #include <SDL2/SDL_image.h>
 #include "sdl_base.h"
 #include "led_controller_common.h"
+#include "led_core.h"
+#include "led_effect.h"
+#include "trace.h"
+#include "embedded_assets.h"
 
 /* Eggshell white color for main text */
-SDL_Color text_color = {255, 239, 186, 255};
+extern SDL_Color text_color;
 
 /* Semi-transparent black for shadow */
-SDL_Color text_shadow_color = {0, 0, 0, 128};
+extern SDL_Color text_shadow_color;
 
-/* The list of colors we support */
-const uint32_t colors[] = {
+/* The stages a headless run reports timings for. */
+typedef enum
+{
+    HEADLESS_STAGE_INPUT,
+    HEADLESS_STAGE_RENDER,
+    HEADLESS_STAGE_CAPTURE,
+    HEADLESS_STAGE_COUNT
+} HeadlessStage;
 
-    // White
-    0xFFFFFF, // White
-    // Greens
-    0x00FF00, // Green
-    0x00FF80, // Aqua
-
-    // Yellows
-    0xFFFF00, // Yellow
-    0x808000, // Olive
-
-    // Blues
-    0x0000FF, // Blue
-    0x0080FF, // Sky Blue
+/**
+ * Parse the command line into an options object.
+ *
+ *  Unknown arguments are logged and ignored.
+ *
+ * Parameters:
+ *      argc - argument count passed to main
+ *      argv - argument vector passed to main
+ *      options - options object to fill, every field is given a default
+ *
+ * Returns:
+ *      0 on success, 1 if any argument wasn't recognized
+ */
+int parse_program_options(int argc, char *argv[], ProgramOptions *options);
 
-    // Cyans
-    0x00FFFF, // Cyan
-    0x008080, // Teal
+/**
+ * Load an input script.
+ *
+ *  Each line is "<frame> <INPUT_NAME>" where INPUT_NAME matches get_input_type_name
+ *  (i.e "30 DPAD_RIGHT"). Lines starting with '#' are comments. Lines must be in frame order.
+ *  Frames are converted to replay clock timestamps of REPLAY_FRAME_MILLIS each.
+ *
+ * Parameters:
+ *      script_path - path of the script to read
+ *      inputs - array to load the inputs into
+ *      capacity - maximum number of inputs the array can hold
+ *
+ * Returns:
+ *      number of inputs loaded, -1 on failure
+ */
+int load_input_script(const char *script_path, RecordedInput *inputs, int capacity);
 
-    // Oranges
-    0xFF8000, // Orange
-    // Reds
-    0xFF0000, // Red
-    // Magentas
-    0xFF00FF, // Magenta
-    0xFF80C0, // Light Magenta
-    // Pinks
-    0xFF0080, // Hot Pink
+/**
+ * Fill an input list with a fixed pseudo random sequence of config page inputs, one per frame.
+ *
+ *  Used by --soak, the menu page is never entered so nothing is installed or uninstalled.
+ *
+ * Parameters:
+ *      inputs - array to fill
+ *      capacity - maximum number of inputs the array can hold
+ *      input_count - number of inputs wanted
+ *
+ * Returns:
+ *      number of inputs generated
+ */
+int generate_soak_inputs(RecordedInput *inputs, int capacity, int input_count);
 
-    0xFF8080, // Light Red
-};
+/**
+ * Point the LED writers at a new, empty scratch directory.
+ *
+ *  Replays, headless benches and soak runs still pay for every LED write but never
+ *  drive the real LEDs. The directory and the files written to it are removed at exit.
+ *
+ * Returns:
+ *      0 on success, 1 if the directory couldn't be created
+ */
+int use_scratch_sys_root(void);
 
-const int num_color = sizeof(colors) / sizeof(colors[0]);
+/**
+ * Apply every due repeat of a held button, then update the LEDs and menu text once.
+ *
+ *  Repeats are applied to the settings one by one, but however many are due
+ *  this frame they cost a single LED commit and text re-render.
+ *
+ * Parameters:
+ *     repeat - hold-to-repeat state fed by button_repeat_track
+ *     now_millis - current SDL_GetTicks() value
+ *     recorder - recorder the repeats are logged to, ignored when it isn't open
+ *     app_state - state object with user information we're updating.
+ *     core_components - core SDL components
+ *     components - SDL components specific to this application
+ *     config_page_ui - user interface object for the config page
+ *     menu_page_ui - user interface object for the menu page
+ */
+void handle_repeated_inputs(ButtonRepeat *repeat, Uint32 now_millis, InputRecorder *recorder, AppState *app_state,
+                            CoreSDLComponents *core_components, AdditionalSDLComponents *components,
+                            SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui);
 
-/* Array of the split suffixs that sont front led files end in*/
-const char *front_led_suffix[2] = {"f1", "f2"};
+/**
+ * Step the selected setting by however far the analog stick moved it this frame.
+ *
+ *  Hue (extended colors) and brightness sweep one wheel entry or brightness unit per
+ *  step as SWEEP_LEFT/SWEEP_RIGHT, other rows step like D-pad left/right presses.
+ *  Either way a single LED commit and text re-render follows, no matter how many
+ *  axis events arrived.
+ *
+ * Parameters:
+ *     stick - analog stick state fed by analog_stick_track
+ *     now_millis - current SDL_GetTicks() value
+ *     recorder - recorder the steps are logged to, ignored when it isn't open
+ *     app_state - state object with user information we're updating.
+ *     core_components - core SDL components
+ *     components - SDL components specific to this application
+ *     config_page_ui - user interface object for the config page
+ *     menu_page_ui - user interface object for the menu page
+ */
+void handle_analog_stick(AnalogStick *stick, Uint32 now_millis, InputRecorder *recorder, AppState *app_state,
+                         CoreSDLComponents *core_components, AdditionalSDLComponents *components,
+                         SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui);
 
 /**
- * Manage what to do with user input.
+ * Feed every replayed input that is due through handle_event_updates.
+ *
+ *  Reaching the end of session marker of a recording sets should_quit.
  *
- *  Shoulder buttons change which LED is selected.
- *  B button quits the application.
- *  DPAD UP/DOWN selects the setting to change
- *  DPAD LEFT/RIGHT changes the setting value
- *  START saves the configuration file.
  * Parameters:
- *      user_input - pre-processed user input converted from SDL_Event
- *      should_quit - loop control flag to exit the main loop.
- *      app_state - state object with user information we're updating.
- *      controller - SDL controller object to read dpad hold inputs from.
- * Returns:
- *      void
+ *     playback - playback cursor over a loaded recording or script
+ *     clock_millis - current time on the replay clock
+ *     app_state - state object with user information we're updating.
+ *     core_components - core SDL components
+ *     components - SDL components specific to this application
+ *     config_page_ui - user interface object for the config page
+ *     menu_page_ui - user interface object for the menu page
  */
-void handle_user_input(InputType user_input, AppState *app_state, SDL_GameController *controller);
+void handle_replayed_inputs(InputPlayback *playback, Uint32 clock_millis, AppState *app_state, CoreSDLComponents *core_components,
+                            AdditionalSDLComponents *components, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui);
 
 /**
- * Control what happens when a LED setting is changed.
+ * Print the LED write, texture, draw call and frame time counters for a replay or headless session.
  *
  * Parameters:
- *      app_state - state object with user information we're updating.
- *      change - the amount to change the setting by.
- * Returns:
- *      void
+ *     frames_rendered - number of frames rendered this session
+ *     render_ticks_total - performance counter ticks spent in render_frame
+ *     render_ticks_max - slowest render_frame in performance counter ticks
  */
-void handle_change_setting(AppState *app_state, int change);
+void log_session_counters(int frames_rendered, Uint64 render_ticks_total, Uint64 render_ticks_max);
 
 /**
- * Control what happens when a menu option is selected.
+ * Render frames offscreen as fast as possible and report frames per second and per-stage timings.
+ *
+ *  Renders options->headless_frame_count frames (or until every replayed input has played),
+ *  feeding replayed inputs through handle_event_updates and optionally dumping every frame to PNG.
+ *  Soak runs (options->soak_input_count) also check that textures, surfaces and SDL
+ *  allocations stay flat once the first SOAK_WARMUP_PERCENT of frames have run.
+ *  options->verify_steady_sdl_heap runs fail if any frame after the first calls SDL_malloc.
  *
  * Parameters:
- *      app_state - state object with user information we're updating.
- *      selected_menu_option - the menu option selected.
+ *     app_state - state object with user information we're updating.
+ *     core_components - core SDL components initialized in headless mode
+ *     components - SDL components specific to this application
+ *     brick_sprite - sprite object to render
+ *     config_page_ui - user interface object for the config page
+ *     menu_page_ui - user interface object for the menu page
+ *     playback - inputs to replay, may be empty
+ *     options - parsed program options
+ *
  * Returns:
- *      void
+ *      0 on success, 1 on failure or if a soak run leaked
  */
-void handle_menu_select(AppState *app_state, MenuOption selected_menu_option);
+int run_headless_session(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite,
+                         SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, InputPlayback *playback,
+                         const ProgramOptions *options);
 
 /**
  * Handle SDL events and update the application state.
@@ -122,17 +209,6 @@ void handle_event_updates(AppState *app_state, CoreSDLComponents *core_component
  */
 int initialize_additional_sdl_components(CoreSDLComponents *core_components, AdditionalSDLComponents *components);
 
-/**
- * Initialize the user state object.
- *
- * Parameters:
- *    app_state - state object to initialize
- *
- * Returns:
- *   0 on success, 1 on failure
- */
-int initialize_app_state(AppState *app_state);
-
 /**
  * Initialize the user interface.
  *
@@ -161,10 +237,9 @@ void initialize_config_page_ui(SelectableMenuItems *menu_items, CoreSDLComponent
 void initialize_menu_ui(SelectableMenuItems *menu_items, CoreSDLComponents *core_components, AdditionalSDLComponents *components, AppState *app_state);
 
 /**
- * Frees all sub-objects of the menu_items
+ * Destroys the text textures of the menu_items
  *
- * Can be used for cleanup and to clear the text off the screen in
- * preparation for the next frame.
+ * The text and texture arrays belong to the UI arena and are released by free_ui_arena.
  */
 void free_menu_items(SelectableMenuItems *menu_items);
 
@@ -197,38 +272,50 @@ void update_menu_ui_text(SelectableMenuItems *menu_items, const CoreSDLComponent
 void update_config_page_ui_text(SelectableMenuItems *menu_items, const CoreSDLComponents *core_components, const AdditionalSDLComponents *components, const AppState *app_state);
 
 /**
- * Read settings from a file.
+ * Initialize the Sprite object responsible for rendering the brick animations.
  *
  * Parameters:
- *      app_state - state object to read settings into
+ *      brick_sprite - sprite object to initialize
+ *      sprite_sheet_texture - brick sprite sheet or atlas loaded at startup, the sprite takes ownership
+ *      sprite_atlas - tile layout of the atlas (frames NULL for the strip), moved into the sprite and zeroed
+ *      arena - UI arena the animation table is carved from
  *
  * Returns:
  *      0 on success, 1 on failure
  */
-int read_settings(AppState *app_state);
+int initialize_brick_sprite(Sprite *brick_sprite, SDL_Texture *sprite_sheet_texture, SpriteAtlas *sprite_atlas, UiArena *arena);
 
 /**
- * Save settings to a file.
+ * Allocate the UI arena, call before the menus and the brick sprite are initialized.
  *
  * Parameters:
- *      app_state - state object to save settings from
+ *      arena - arena to set up
+ *      capacity - bytes to reserve, UI_ARENA_SIZE covers every UI structure
  *
  * Returns:
  *      0 on success, 1 on failure
  */
-int save_settings(AppState *app_state);
+int initialize_ui_arena(UiArena *arena, size_t capacity);
 
 /**
- * Initialize the Sprite object responsible for rendering the brick animations.
+ * Carve zeroed, UI_ARENA_ALIGNMENT aligned memory out of the UI arena.
  *
  * Parameters:
- *      brick_sprite - sprite object to initialize
- *      renderer - SDL renderer to draw to
+ *      arena - arena set up by initialize_ui_arena
+ *      size - bytes needed
  *
  * Returns:
- *      0 on success, 1 on failure
+ *      the memory, NULL if the arena is out of space
+ */
+void *ui_arena_alloc(UiArena *arena, size_t size);
+
+/**
+ * Release the UI arena and everything carved from it.
+ *
+ * Parameters:
+ *      arena - arena to free
  */
-int initialize_brick_sprite(Sprite *brick_sprite, SDL_Renderer *renderer);
+void free_ui_arena(UiArena *arena);
 
 /**
  * Render the main application frame to the screen.
@@ -242,10 +329,11 @@ int initialize_brick_sprite(Sprite *brick_sprite, SDL_Renderer *renderer);
  *     brick_sprite - sprite object to render
  *     config_page_ui - user interface object for the config page
  *     menu_page_ui - user interface object for the menu page
+ *     frame_millis - clock the frame is drawn at, the replay clock when replaying so frame dumps are reproducible
  *     verbose_logging_enabled - flag to enable verbose logging
  *
  */
-void render_frame(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, bool verbose_logging_enabled);
+void render_frame(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, Uint32 frame_millis, bool verbose_logging_enabled);
 
 /**
  * Render a colored square to the screen.
@@ -253,17 +341,18 @@ void render_frame(AppState *app_state, CoreSDLComponents *core_components, Addit
  * Parameters:
  *      app_state - state object with user information we're updating.
  *      core_components - core SDL components
+ *      frame_millis - time the effect preview is sampled at
  *
  * Returns:
  *      void
  */
-void render_colored_square(AppState *app_state, CoreSDLComponents *core_components);
+void render_colored_square(AppState *app_state, CoreSDLComponents *core_components, Uint32 frame_millis);
 
 /**
  * Render a text texture to the screen.
  *
  * Parameters:
- *      renderer - SDL renderer to draw to.
+ *      batch - render batch to queue the text in
  *      texture - SDL texture containing the text
  *      x - x position to render the text
  *      y - y position to render the text
@@ -271,13 +360,13 @@ void render_colored_square(AppState *app_state, CoreSDLComponents *core_componen
  * Returns:
  *      void
  */
-void render_text_texture(SDL_Renderer *renderer, SDL_Texture *texture, int x, int y);
+void render_text_texture(RenderBatch *batch, SDL_Texture *texture, int x, int y);
 
 /**
  * Render the user interface to the screen.
  *
  * Parameters:
- *      renderer - SDL renderer to draw to.
+ *      batch - render batch to queue the menu text in
  *      menu_items - user interface object to render
  *      start_x - x position to start rendering
  *      start_y - y position to start rendering
@@ -285,7 +374,7 @@ void render_text_texture(SDL_Renderer *renderer, SDL_Texture *texture, int x, in
  * Returns:
  *      void
  */
-void render_menu_items(SDL_Renderer *renderer, SelectableMenuItems *menu_items, int start_x, int start_y);
+void render_menu_items(RenderBatch *batch, SelectableMenuItems *menu_items, int start_x, int start_y);
 
 /**
  * Load an image from a file.
@@ -322,128 +411,5 @@ void update_led_sys_files();
  */
 int teardown(CoreSDLComponents *core_components, AdditionalSDLComponents *components,
              SelectableMenuItems *config_menu_items, SelectableMenuItems *main_menu_items, Sprite *brick_sprite, AppState *app_state);
-/**
- * Write the max scale data to a file.
- *
- * Parameters:
- *      file - file to write to
- *      app_state - state object with user information we're updating.
- *      led - LED to write the data for
- *      filepath - path to the file
- *
- * Returns:
- *      void
- */
-void write_max_scale_data(FILE *file, const AppState *app_state, const Led led, char *filepath);
-
-/**
- * Write the effect data to a file.
- *
- * Parameters:
- *      file - file to write to
- *      app_state - state object with user information we're updating.
- *      led - LED to write the data for
- *      filepath - path to the file
- *
- * Returns:
- *      void
- */
-void write_effect_data(FILE *file, const AppState *app_state, const Led led, char *filepath);
-
-/**
- * Write the effect duration data to a file.
- *
- * Parameters:
- *      file - file to write to
- *      app_state - state object with user information we're updating.
- *      led - LED to write the data for
- *      filepath - path to the file
- *
- * Returns:
- *      void
- */
-void write_effect_duration_data(FILE *file, const AppState *app_state, const Led led, char *filepath);
-
-/**
- * Write the color data to a file.
- *
- * Parameters:
- *      file - file to write to
- *      app_state - state object with user information we're updating.
- *      led - LED to write the data for
- *      filepath - path to the file
- *
- * Returns:
- *      void
- */
-void write_color_data(FILE *file, const AppState *app_state, const Led led, char *filepath);
-
-/**
- * Write user selection data to the associated LED files.
- *
- *  Opens several files in the /sys/class/led_anim directory and writes
- *  the user selected values to the files. The firmware continually
- *  checks the values in this directory and updates the LEDs accordingly.
- *
- * Parameters:
- *      app_state - state object with user information we're updating.
- *
- * Returns:
- *      void
- */
-void update_leds(AppState *app_state);
-
-/**
- * Install the daemon.
- *
- *  Runs the install.sh script to install the daemon.
- *
- * Returns:
- *      void
- */
-void install_daemon();
-
-/**
- * Uninstall the daemon.
- *
- *  Runs the uninstall.sh script to uninstall the daemon.
- *
- * Returns:
- *      void
- */
-void uninstall_daemon();
-
-/**
- * Quick action that matches all LED colors to the current
- *
- * Parameters:
- *      app_state - state object with user information we're updating.
- *
- * Returns:
- *      void
- */
-void color_match_leds(AppState *app_state);
-
-/**
- * Turn off all LEDs.
- *
- * Parameters:
- *      app_state - state object with led information that must be updated.
- *
- * Returns:
- *      void
- */
-void turn_off_all_leds(AppState *app_state);
-
-/**
- * Turn on all LEDs.
- *
- * Parameters:
- *      app_state - state object with led information that must be updated.
- *
- * Returns:
- *      void
- */
-void turn_on_all_leds(AppState *app_state);
 
 #endif
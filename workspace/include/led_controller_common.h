@@ -5,17 +5,20 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 #include <stdbool.h>
+#include "led_core.h"
+#include "launcher.h"
+#include "sprite_atlas.h"
 
 // ** File locations **
 #define IMAGE_DIR "assets/images"
 #define BACKGROUND_IMAGE_PATH "assets/images/background.png"
 #define MENU_IMAGE_PATH "assets/images/main_menu.png"
 #define BRICK_SPRITE_SHEET_PATH "assets/images/brick_sprite_sheet.png"
+/* Written by make sprite_atlas, the strip above is used when they are missing */
+#define BRICK_SPRITE_ATLAS_PATH "assets/images/brick_sprite_atlas.png"
+#define BRICK_SPRITE_ATLAS_INDEX_PATH "assets/images/brick_sprite_atlas.index"
 #define FONT_PATH "assets/retro_gaming.ttf"
-#define SETTINGS_FILE "settings.ini"
 #define UPDATE_LED_SYS_FILES_SCRIPT "./update_led_sys_files.sh"
-/* Location of system files we need to edit to change LEDs */
-#define SYS_FILE_PATH "/sys/class/led_anim"
 
 // ** SDL/Animation Consts **
 /* TrimUI Brick WxH */
@@ -25,82 +28,43 @@
 #define WINDOW_TITLE "Led Controller"
 #define BRICK_SPRITE_HEIGHT 512
 #define BRICK_SPRITE_WIDTH 512
+#define BRICK_SPRITE_FRAME_COUNT 9
 
 /* Indicator to render current user selection (i.e '>>> Brightness: 100') */
 #define MENU_CARRET_LEFT "<  "
 #define MENU_CARRET_RIGHT "  >"
 
-//  ** Settings Consts **
-/* FRONT, TOP, BACK */
-#define LED_COUNT 3
-/* brightness, effect, color, duration */
-#define LED_SETTINGS_COUNT 6
-
-/* enable all, disable all, uninstall, quit*/
-#define MENU_OPTION_COUNT 6
-
-/* DISABLE, LINEAR, BREATH, SNIFF, STATIC, BLINK1, BLINK2, BLINK3 */
-#define ANIMATION_EFFECT_COUNT 8
-/* 0xRRGGBBAA */
-#define COLOR_HEX_LENGTH 8
-/* Maximum brightness value allowed by trimui firmware */
-#define MAX_BRIGHTNESS 100
-/* Maximum duration to cycle a lighting effect */
-#define MAX_DURATION 5000
-/* How much to increment duration by when the user increases/decreases */
-#define DURATION_INCREMENT 500
-/* How much to increment the brightness by when increasing/decreasing */
-#define BRIGHTNESS_INCREMENT 10
-/* How many colors we support */
-#define NUM_COLORS 17
-/* Application Consts */
-#define STRING_LENGTH 256
-/*How much to increment/decrement the color when the user changes the value in extened color mode*/
-#define COLOR_CYLCE_INCREMENT 16
-
-/* The different Led clusters we support */
-typedef enum
-{
-  LED_FRONT,
-  LED_TOP,
-  LED_BACK,
-} Led;
-
-/* The different Animation effect options recognized by the TrimUI firmware */
-/* Reference:  "/sys/class/led_anim/help" */
-typedef enum
-{
-  DISABLE,
-  LINEAR,
-  BREATH,
-  SNIFF,
-  STATIC,
-  BLINK1,
-  BLINK2,
-  BLINK3
-} AnimationEffect;
-
-/* The different LED functions we support modifying */
-typedef enum
-{
-  SELECTED_LED,
-  BRIGHTNESS,
-  EFFECT,
-  DURATION,
-  COLOR,
-  MATCH_SETTINGS
-} LedSettingOption;
-
-/* The different menu options we provide */
-typedef enum
+/* How many frames a headless run renders when no count is given */
+#define HEADLESS_DEFAULT_FRAME_COUNT 600
+/* Maximum number of inputs loaded from an input script or recording */
+#define REPLAY_INPUT_CAPACITY 65536
+/* How far the replay clock advances per frame at maximum speed, matches the ~60 fps frame delay */
+#define REPLAY_FRAME_MILLIS 16
+/* mkdtemp template for the LED file tree replays and headless runs write to when --sys-root= isn't given */
+#define SCRATCH_SYS_ROOT_TEMPLATE "/tmp/led_controller_sys.XXXXXX"
+/* Share of a --soak run spent warming caches before its resource counts are taken */
+#define SOAK_WARMUP_PERCENT 10
+/* Live SDL_malloc allocations a --soak run may gain after warming up, i.e SDL_ttf's glyph caches (FreeType's own libc heap isn't counted) */
+#define SOAK_ALLOCATION_SLACK 64
+/* Every UiArena allocation starts on this boundary */
+#define UI_ARENA_ALIGNMENT 16
+/* Allocations carved from the UI arena: two arrays and one string per item of both menus, plus the sprite animations */
+#define UI_ARENA_ALLOCATION_COUNT (2 * 2 + LED_SETTINGS_COUNT + MENU_OPTION_COUNT + 1)
+/* Bytes behind every menu and sprite structure, the sizes are all compile time constants */
+#define UI_ARENA_SIZE                                                                                        \
+  ((LED_SETTINGS_COUNT + MENU_OPTION_COUNT) * (sizeof(char *) + sizeof(SDL_Texture *) + STRING_LENGTH) + \
+   LED_COUNT * sizeof(AnimationInfo) + UI_ARENA_ALLOCATION_COUNT * UI_ARENA_ALIGNMENT)
+
+/* One block allocated at startup that the menus and the brick sprite carve their memory from.
+ *
+ * Nothing is ever freed individually, free_ui_arena releases everything at once.
+ */
+typedef struct
 {
-  ENABLE_ALL,
-  DISABLE_ALL,
-  TOGGLE_EXTENDED_COLORS,
-  TOGGLE_LOW_BATTERY_INDICATION,
-  UNINSTALL,
-  QUIT,
-} MenuOption;
+  unsigned char *memory;
+  size_t capacity;
+  size_t used;
+} UiArena;
 
 /* SDL Extended set of components required by this application not covered in sdl_base::CoreSDLComponents */
 typedef struct
@@ -108,6 +72,12 @@ typedef struct
   SDL_Texture *backgroundTexture;
   SDL_Texture *menuTexture;
   TTF_Font *font;
+  /* Uploaded with the other startup assets, owned by the brick sprite after initialize_brick_sprite */
+  SDL_Texture *brickSpriteSheetTexture;
+  /* Tile layout of brickSpriteSheetTexture when it holds the atlas, zeroed for the strip */
+  SpriteAtlas brickSpriteAtlas;
+  /* Backs the menu text, menu texture arrays and sprite animations */
+  UiArena ui_arena;
 } AdditionalSDLComponents;
 
 /* Cluster of all mutable user-interface related objects */
@@ -123,147 +93,42 @@ typedef struct
 
 } SelectableMenuItems;
 
-/* Collection of values for each supported LED setting. */
-typedef struct
-{
-  int brightness;
-  AnimationEffect effect;
-  uint32_t color;
-  int duration;
-} LedSettings;
-
-typedef enum
-{
-  CONFIG_PAGE,
-  MENU_PAGE,
-} ApplicationPage;
-
+/* Options parsed from the command line. */
 typedef struct
 {
-  bool should_save_settings;
-  bool should_update_leds;
-  bool should_quit;
-  bool should_install_daemon;
-  bool are_extended_colors_enabled;
-  bool should_enable_low_battery_indication;
-  ApplicationPage current_page;
-  Led selected_led;
-  LedSettingOption selected_setting;
-  MenuOption selected_menu_option;
-  LedSettings led_settings[LED_COUNT];
-} AppState;
-
-/**
- * Convert a color to a string.
- *
- * Parameters:
- *      color - 0x8 RGB hex value of the color to convert
- *
- * Returns:
- *      string containing the color
- */
-const char *color_to_string(uint32_t color);
-
-/**
- * Cycles to the next color in the color wheel.
- *
- * This is used to cycle colors in the extended color mode.
- * Parameters:
- *    color - the current 0xRRGGBBAA color to cycle from
- *   sign - direction to cycle the color
- */
-uint32_t next_color(uint32_t color, int sign);
-/**
- * Convert an animation effect to a string.
- *
- * Parameters:
- *      effect - animation effect to convert
- *
- * Returns:
- *      string containing the animation effect
- */
-const char *animation_effect_to_string(AnimationEffect effect);
+  bool verbose_logging_enabled;
+  /* Write a Chrome trace-event file here on exit (--trace=path.json) */
+  const char *trace_output_path;
+  /* Render offscreen as fast as possible and report timings (--headless) */
+  bool headless;
+  /* Minimum number of frames a headless run renders (--frames=N) */
+  int headless_frame_count;
+  /* Text file of "<frame> <INPUT_NAME>" lines replayed by a headless run (--input-script=path) */
+  const char *input_script_path;
+  /* Directory to write frame_NNNNN.png captures to during a headless run (--dump-frames=dir) */
+  const char *frame_dump_directory;
+  /* Record every input with its timestamp to this binary log (--record=path) */
+  const char *record_path;
+  /* Replay a binary log written by --record (--replay=path) */
+  const char *replay_path;
+  /* Replay on a fixed per-frame clock instead of in real time (--replay-speed=max|original) */
+  bool replay_at_max_speed;
+  /* Directory used in place of SYS_FILE_PATH for LED writes (--sys-root=dir) */
+  const char *sys_file_root;
+  /* Replace launch.sh: log, unlock the LED files and clean up on exit (--launch) */
+  bool launch;
+  /* Upload images as 32 bit textures even when a 16 bit format would hold them (--full-color-textures) */
+  bool full_color_textures;
+  /* Render driver for this run, or "auto" to probe again and cache the winner (--renderer=name|auto) */
+  const char *renderer_name;
+  /* How long a D-pad or shoulder button is held before it repeats (--repeat-delay=ms) */
+  int repeat_delay_millis;
+  /* How much faster each repeat comes than the last, 0 for a fixed rate (--repeat-acceleration=percent) */
+  int repeat_acceleration_percent;
+  /* Headless run of this many synthetic inputs that fails if textures, surfaces or allocations leak (--soak=N) */
+  int soak_input_count;
+  /* Headless run without input that fails if anything calls SDL_malloc after the first frame (--verify-steady-sdl-heap) */
+  bool verify_steady_sdl_heap;
+} ProgramOptions;
 
-/**
- * Convert a LED setting option to a string.
- *
- * Parameters:
- *      setting - LED setting option to convert
- *
- * Returns:
- *      string containing the LED setting option
- */
-const char *led_setting_option_to_string(LedSettingOption setting);
-
-/**
- * Convert a menu option to a string.
- *
- * Parameters:
- *    option - menu option to convert
- *    app_state - application state to reference for conditional strings
- *
- * Returns:
- *   string containing the menu option
- */
-
-const char *menu_option_to_string(MenuOption option, const AppState *app_state);
-
-/**
- * Convert a LED to a string.
- *
- * Parameters:
- *      led - LED to convert
- *
- * Returns:
- *      string containing the LED
- */
-const char *led_to_string(Led led);
-
-/**
- * Get the internal name of a LED.
- *
- * Parameters:
- *      led - LED to get the internal name of
- *
- * Returns:
- *      string containing the internal name of the LED
- */
-const char *led_internal_name(Led led);
-
-/**
- * Convert an internal LED name to an index.
- *
- * Parameters:
- *      led_name - internal name of the LED
- *
- * Returns:
- *     Led object
- */
-Led internal_led_name_to_led(const char *led_name);
-
-/**
-
- * Log a debug message.
- *
- * Parameters:
- *      message - message to log
- *      verbose_logging_enabled - flag to enable verbose logging
- *
- * Returns:
- *      void
- */
-void debug_log(const char *message, bool verbose_logging_enabled);
-
-/**
- * Clamp a value between a minimum and maximum value.
- *
- * Parameters:
- *      value - the value to clamp
- *      min - the minimum value
- *      max - the maximum value
- *
- * Returns:
- *      the clamped value
- */
-int clamp(int value, int min, int max);
 #endif
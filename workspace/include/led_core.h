@@ -0,0 +1,782 @@
+#ifndef LED_CORE_H
+#define LED_CORE_H
+
+/* SDL-free LED controller logic: state transitions, settings I/O and LED commits.
+ *
+ * Built into libledcore so the UI, the settings daemon, ledctl and the
+ * benchmarks share one implementation without linking SDL.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "input_type.h"
+
+// ** File locations **
+#define SETTINGS_FILE "settings.ini"
+/* Location of system files we need to edit to change LEDs */
+#define SYS_FILE_PATH "/sys/class/led_anim"
+/* Copy of the settings file install_daemon places next to the daemon */
+#define INSTALLED_SETTINGS_FILE "/etc/led_controller/settings.ini"
+/* Init script install_daemon copies and enables */
+#define INSTALLED_INIT_SCRIPT "/etc/init.d/led-settings-daemon"
+
+//  ** Settings Consts **
+/* FRONT, TOP, BACK */
+#define LED_COUNT 3
+/* brightness, effect, color, duration */
+#define LED_SETTINGS_COUNT 6
+
+/* enable all, disable all, uninstall, quit*/
+#define MENU_OPTION_COUNT 6
+
+/* DISABLE, LINEAR, BREATH, SNIFF, STATIC, BLINK1, BLINK2, BLINK3 */
+#define ANIMATION_EFFECT_COUNT 8
+/* 0xRRGGBBAA */
+#define COLOR_HEX_LENGTH 8
+/* Maximum brightness value allowed by trimui firmware */
+#define MAX_BRIGHTNESS 100
+/* Maximum duration to cycle a lighting effect */
+#define MAX_DURATION 5000
+/* How much to increment duration by when the user increases/decreases */
+#define DURATION_INCREMENT 500
+/* How much to increment the brightness by when increasing/decreasing */
+#define BRIGHTNESS_INCREMENT 10
+/* How many colors we support */
+#define NUM_COLORS 17
+/* Application Consts */
+#define STRING_LENGTH 256
+/* Distinct hues between two neighbouring primary/secondary colors, i.e Red up to but not including Yellow */
+#define HUE_SEGMENT_LENGTH 255
+/* Entries in the hue wheel, one segment each of Red -> Yellow -> Green -> Cyan -> Blue -> Magenta -> Red */
+#define HUE_WHEEL_SIZE (6 * HUE_SEGMENT_LENGTH)
+/*How much to increment/decrement the color when the user changes the value in extened color mode,
+ * 30 presses go around the wheel and every fifth one lands on a primary or secondary color*/
+#define COLOR_CYLCE_INCREMENT (HUE_SEGMENT_LENGTH / 5)
+/* Fine steps per second with the stick fully pushed, one hue wheel entry each, i.e the whole wheel in 3 seconds */
+#define SWEEP_HUE_STEPS_PER_SECOND (HUE_WHEEL_SIZE / 3)
+/* Fine steps per second with the stick fully pushed, one brightness unit each, i.e 0 to full in 2 seconds */
+#define SWEEP_BRIGHTNESS_STEPS_PER_SECOND (MAX_BRIGHTNESS / 2)
+/* How long settings must stay unchanged before a requested save is written */
+#define SETTINGS_SAVE_DEBOUNCE_MILLIS 1500
+/* Largest settings file save_settings can produce */
+#define SETTINGS_TEXT_CAPACITY 1024
+/* Starting value for content_hash */
+#define CONTENT_HASH_SEED 0xcbf29ce484222325ull
+/* Longest SDL render driver name kept in settings.ini, i.e "opengles2" */
+#define RENDERER_NAME_LENGTH 32
+
+/* The different Led clusters we support */
+typedef enum
+{
+  LED_FRONT,
+  LED_TOP,
+  LED_BACK,
+} Led;
+
+/* The different Animation effect options recognized by the TrimUI firmware */
+/* Reference:  "/sys/class/led_anim/help" */
+typedef enum
+{
+  DISABLE,
+  LINEAR,
+  BREATH,
+  SNIFF,
+  STATIC,
+  BLINK1,
+  BLINK2,
+  BLINK3
+} AnimationEffect;
+
+/* The different LED functions we support modifying */
+typedef enum
+{
+  SELECTED_LED,
+  BRIGHTNESS,
+  EFFECT,
+  DURATION,
+  COLOR,
+  MATCH_SETTINGS
+} LedSettingOption;
+
+/* The different menu options we provide */
+typedef enum
+{
+  ENABLE_ALL,
+  DISABLE_ALL,
+  TOGGLE_EXTENDED_COLORS,
+  TOGGLE_LOW_BATTERY_INDICATION,
+  UNINSTALL,
+  QUIT,
+} MenuOption;
+
+/* Every per-LED setting, in settings file and sysfs write order.
+ *
+ * X(type, field, FIELD_ID, option, key, minimum, maximum, step, base, label, sysfs_attribute, splits_front_led, ini_format, sysfs_format, format_value)
+ *
+ *  type/field - member of LedSettings
+ *  FIELD_ID - LedSettingField index used for lookups and dirty tracking
+ *  option - config page row that edits it
+ *  key/base - settings.ini key and the number base its value is written in
+ *  minimum/maximum/step - bounds every write is clamped to and the change per press (0 if custom)
+ *  label - config page row prefix
+ *  sysfs_attribute/splits_front_led - LED file prefix and whether the front LED has separate f1/f2 files
+ *  ini_format/sysfs_format - printf formats for the settings file and the LED file
+ *  format_value - function that writes the value as the config page shows it
+ *
+ * Keys must stay in alphabetical order, the settings parser binary searches them.
+ * effect must stay last, commit_dirty_leds writes it after the values it starts.
+ */
+#define LED_SETTINGS_SCHEMA(X)                                                                                                          \
+  X(int, brightness, LED_FIELD_BRIGHTNESS, BRIGHTNESS, "brightness", 0, MAX_BRIGHTNESS, BRIGHTNESS_INCREMENT, 10, "Brightness: ",     \
+    "max_scale", false, "%d", "%d\n", format_brightness_value)                                                                          \
+  X(uint32_t, color, LED_FIELD_COLOR, COLOR, "color", 0, 0xFFFFFF, 0, 16, "Color:   ",                                                  \
+    "effect_rgb_hex", true, "0x%06X", "%06X\n", format_color_value)                                                                     \
+  X(int, duration, LED_FIELD_DURATION, DURATION, "duration", 0, MAX_DURATION, DURATION_INCREMENT, 10, "Duration: ",                     \
+    "effect_duration", true, "%d", "%d\n", format_duration_value)                                                                       \
+  X(AnimationEffect, effect, LED_FIELD_EFFECT, EFFECT, "effect", 0, ANIMATION_EFFECT_COUNT - 1, 1, 10, "Effect:     ",                 \
+    "effect", true, "%d", "%d\n", format_effect_value)
+
+#define LED_SETTINGS_DECLARE_FIELD(type, field, ...) type field;
+#define LED_SETTINGS_DECLARE_FIELD_ID(type, field, FIELD_ID, ...) FIELD_ID,
+
+/* Collection of values for each supported LED setting. */
+typedef struct
+{
+  LED_SETTINGS_SCHEMA(LED_SETTINGS_DECLARE_FIELD)
+} LedSettings;
+
+/* Constant-time index of each LedSettings member. */
+typedef enum
+{
+  LED_SETTINGS_SCHEMA(LED_SETTINGS_DECLARE_FIELD_ID)
+  LED_FIELD_COUNT
+} LedSettingField;
+
+/* One row of LED_SETTINGS_SCHEMA, see it for what each member means. */
+typedef struct
+{
+  const char *key;
+  size_t key_length;
+  LedSettingOption option;
+  int minimum;
+  int maximum;
+  int step;
+  int base;
+  const char *label;
+  const char *sysfs_attribute;
+  bool splits_front_led;
+  const char *ini_format;
+  const char *sysfs_format;
+  void (*format_value)(int value, char *buffer, size_t buffer_size);
+} LedSettingDescriptor;
+
+/* Where a run of fine hue steps is on the wheel.
+ *
+ * Dim and pale colors round several neighbouring wheel entries to the same RGB
+ * value, so single steps re-derived from the color would stall. The sweep keeps
+ * its own position while the color is still the one it produced.
+ */
+typedef struct
+{
+  bool is_active;
+  uint32_t color;
+  int hue_index;
+  int saturation;
+  int value;
+} HueSweep;
+
+typedef enum
+{
+  CONFIG_PAGE,
+  MENU_PAGE,
+} ApplicationPage;
+
+typedef struct
+{
+  bool should_save_settings;
+  bool should_update_leds;
+  bool should_quit;
+  bool should_install_daemon;
+  bool are_extended_colors_enabled;
+  bool should_enable_low_battery_indication;
+  /* Replays and headless runs, menu actions leave the installed daemon and system files alone */
+  bool is_dry_run;
+  ApplicationPage current_page;
+  Led selected_led;
+  LedSettingOption selected_setting;
+  MenuOption selected_menu_option;
+  LedSettings led_settings[LED_COUNT];
+  /* Render driver picked by the startup probe, empty until one has run ([global] renderer=) */
+  char renderer_name[RENDERER_NAME_LENGTH];
+  /* When the last change arrived, used to debounce saves */
+  uint32_t settings_changed_millis;
+  /* Bit (1 << LedSettingField) is set for every value not yet written to the LED files */
+  uint32_t dirty_led_fields[LED_COUNT];
+  /* Position of the analog stick's hue sweep, see sweep_color */
+  HueSweep hue_sweep;
+} AppState;
+
+/* Generated from LED_SETTINGS_SCHEMA, indexed by LedSettingField. */
+extern const LedSettingDescriptor led_setting_descriptors[LED_FIELD_COUNT];
+
+/* The list of colors we support */
+extern const uint32_t colors[];
+
+extern const int num_color;
+
+/* Array of the split suffixs that sont front led files end in*/
+extern const char *front_led_suffix[2];
+
+/* Directory the LED writers write to, swapped for a fake tree with --sys-root */
+extern const char *led_sys_file_path;
+
+/* Settings file read_settings and save_settings use, the daemon points this at the installed copy */
+extern const char *settings_file_path;
+
+/* Number of LED system files written this session */
+extern unsigned long led_sys_file_write_count;
+
+/**
+ * Convert a color to a string.
+ *
+ * Parameters:
+ *      color - 0x8 RGB hex value of the color to convert
+ *
+ * Returns:
+ *      string containing the color
+ */
+const char *color_to_string(uint32_t color);
+
+/**
+ * Cycles to the next color in the color wheel.
+ *
+ *  This is used to cycle colors in the extended color mode. The color moves
+ *  around the hue wheel and keeps its saturation and value, so pastel and
+ *  dim colors stay pastel and dim. Grays have no hue and start from full
+ *  saturation.
+ *
+ * Parameters:
+ *      color - the current 0xRRGGBB color to cycle from
+ *      hue_steps - hue wheel entries to move, negative to go backwards
+ *
+ * Returns:
+ *      the new 0xRRGGBB color
+ */
+uint32_t next_color(uint32_t color, int hue_steps);
+
+/**
+ * Move a color around the hue wheel, continuing from where the last call left it.
+ *
+ *  Same as next_color, but when color is the one the previous call returned the
+ *  step starts from the stored wheel position, saturation and value instead of
+ *  re-deriving them, so single steps always make progress.
+ *
+ * Parameters:
+ *      sweep - sweep position, zero it (or clear is_active) to start over
+ *      color - the current 0xRRGGBB color
+ *      hue_steps - hue wheel entries to move, negative to go backwards
+ *
+ * Returns:
+ *      the new 0xRRGGBB color
+ */
+uint32_t sweep_color(HueSweep *sweep, uint32_t color, int hue_steps);
+
+/**
+ * Fully saturated, full value color at a hue wheel position.
+ *
+ * Parameters:
+ *      hue_index - position on the wheel, wrapped into [0, HUE_WHEEL_SIZE)
+ *
+ * Returns:
+ *      0xRRGGBB color
+ */
+uint32_t hue_wheel_color(int hue_index);
+
+/**
+ * Build a color from hue wheel position, saturation and value.
+ *
+ * Parameters:
+ *      hue_index - position on the wheel, wrapped into [0, HUE_WHEEL_SIZE)
+ *      saturation - 0 (gray) to 255 (pure hue)
+ *      value - 0 (black) to 255 (full)
+ *
+ * Returns:
+ *      0xRRGGBB color
+ */
+uint32_t hsv_color(int hue_index, int saturation, int value);
+
+/**
+ * Split a color into hue wheel position, saturation and value in constant time.
+ *
+ *  Colors on the wheel map back to their exact index, so
+ *  hue_wheel_color(hue_index) returns the same color.
+ *
+ * Parameters:
+ *      color - 0xRRGGBB color
+ *      hue_index - receives the wheel position, 0 for grays
+ *      saturation - receives the saturation, may be NULL
+ *      value - receives the value, may be NULL
+ */
+void color_to_hsv(uint32_t color, int *hue_index, int *saturation, int *value);
+/**
+ * Convert an animation effect to a string.
+ *
+ * Parameters:
+ *      effect - animation effect to convert
+ *
+ * Returns:
+ *      string containing the animation effect
+ */
+const char *animation_effect_to_string(AnimationEffect effect);
+
+/**
+ * Convert a LED setting option to a string.
+ *
+ * Parameters:
+ *      setting - LED setting option to convert
+ *
+ * Returns:
+ *      string containing the LED setting option
+ */
+const char *led_setting_option_to_string(LedSettingOption setting);
+
+/**
+ * Convert a menu option to a string.
+ *
+ * Parameters:
+ *    option - menu option to convert
+ *    app_state - application state to reference for conditional strings
+ *
+ * Returns:
+ *   string containing the menu option
+ */
+
+const char *menu_option_to_string(MenuOption option, const AppState *app_state);
+
+/**
+ * Convert a LED to a string.
+ *
+ * Parameters:
+ *      led - LED to convert
+ *
+ * Returns:
+ *      string containing the LED
+ */
+const char *led_to_string(Led led);
+
+/**
+ * Get the internal name of a LED.
+ *
+ * Parameters:
+ *      led - LED to get the internal name of
+ *
+ * Returns:
+ *      string containing the internal name of the LED
+ */
+const char *led_internal_name(Led led);
+
+/**
+ * Convert an internal LED name to an index.
+ *
+ * Parameters:
+ *      led_name - internal name of the LED
+ *
+ * Returns:
+ *     Led object
+ */
+Led internal_led_name_to_led(const char *led_name);
+
+/**
+
+ * Log a debug message.
+ *
+ * Parameters:
+ *      message - message to log
+ *      verbose_logging_enabled - flag to enable verbose logging
+ *
+ * Returns:
+ *      void
+ */
+void debug_log(const char *message, bool verbose_logging_enabled);
+
+/**
+ * Clamp a value between a minimum and maximum value.
+ *
+ * Parameters:
+ *      value - the value to clamp
+ *      min - the minimum value
+ *      max - the maximum value
+ *
+ * Returns:
+ *      the clamped value
+ */
+int clamp(int value, int min, int max);
+
+/**
+ * Manage what to do with user input.
+ *
+ *  Shoulder buttons change which LED is selected.
+ *  B button quits the application.
+ *  DPAD UP/DOWN selects the setting to change
+ *  DPAD LEFT/RIGHT changes the setting value
+ *  START saves the configuration file.
+ * Parameters:
+ *      user_input - pre-processed user input, i.e converted from an SDL_Event
+ *      should_quit - loop control flag to exit the main loop.
+ *      app_state - state object with user information we're updating.
+ * Returns:
+ *      void
+ */
+void handle_user_input(InputType user_input, AppState *app_state);
+
+/**
+ * Control what happens when a LED setting is changed.
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *      change - the amount to change the setting by.
+ * Returns:
+ *      void
+ */
+void handle_change_setting(AppState *app_state, int change);
+
+/**
+ * How fast the selected setting can be swept in fine steps.
+ *
+ *  Hue (extended colors) and brightness are continuous, the stick moves them
+ *  one wheel entry or brightness unit at a time with SWEEP_LEFT/SWEEP_RIGHT.
+ *
+ * Parameters:
+ *      app_state - state object with the selected page and setting
+ *
+ * Returns:
+ *      fine steps per second at full deflection, 0 if the setting is discrete
+ */
+int sweep_steps_per_second(const AppState *app_state);
+
+/**
+ * Move a continuous setting by fine steps, one hue wheel entry or brightness unit each.
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *      steps - fine steps to move, negative to go backwards
+ * Returns:
+ *      void
+ */
+void handle_sweep_setting(AppState *app_state, int steps);
+
+/**
+ * Control what happens when a menu option is selected.
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *      selected_menu_option - the menu option selected.
+ * Returns:
+ *      void
+ */
+void handle_menu_select(AppState *app_state, MenuOption selected_menu_option);
+
+/**
+ * Initialize the user state object.
+ *
+ * Parameters:
+ *    app_state - state object to initialize
+ *
+ * Returns:
+ *   0 on success, 1 on failure
+ */
+int initialize_app_state(AppState *app_state);
+
+/**
+ * Read settings from a file.
+ *
+ * Parameters:
+ *      app_state - state object to read settings into
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int read_settings(AppState *app_state);
+
+/**
+ * Apply the contents of a settings file to the state object.
+ *
+ *  Single pass over the buffer with no allocations, it doesn't need to be
+ *  NUL terminated so it can point straight at an mmap of the file. Keys are
+ *  looked up in a sorted table and every value goes through the same clamp
+ *  rules the UI uses. Unknown sections, keys and malformed values are skipped.
+ *
+ * Parameters:
+ *      buffer - settings file contents
+ *      length - number of bytes in buffer
+ *      app_state - state object to read settings into
+ *
+ * Returns:
+ *      the number of settings applied
+ */
+int parse_settings_buffer(const char *buffer, size_t length, AppState *app_state);
+
+/**
+ * Find the schema field a settings key names.
+ *
+ * Parameters:
+ *      key - settings file key, i.e "brightness"
+ *
+ * Returns:
+ *      the matching field, LED_FIELD_COUNT for [global] and unknown keys
+ */
+LedSettingField led_setting_field_for_key(const char *key);
+
+/**
+ * Parse a setting value the same way the settings file reader does.
+ *
+ *  Uses the field's number base and saturates instead of overflowing,
+ *  set_led_setting clamps the result to the field's bounds.
+ *
+ * Parameters:
+ *      field - setting the value is for
+ *      text - value as typed, i.e "60" or "0xFF0000" for color
+ *      value - where the parsed value is stored
+ *
+ * Returns:
+ *      true if text starts with a number
+ */
+bool parse_led_setting_value(LedSettingField field, const char *text, int *value);
+
+/**
+ * Save settings to a file.
+ *
+ *  Writes a temporary file, fsyncs it and renames it over the settings file
+ *  so a power cut can't leave a truncated file behind. Nothing is written
+ *  when the text matches what was last read or saved.
+ *
+ * Parameters:
+ *      app_state - state object to save settings from
+ *
+ * Returns:
+ *      0 on success (including skipped saves), 1 on failure
+ */
+int save_settings(AppState *app_state);
+
+/**
+ * Mark the settings as changed and restart the save debounce timer.
+ *
+ * Parameters:
+ *      app_state - state object with unsaved changes
+ *      now_millis - current time in milliseconds, from any monotonic clock
+ */
+void request_settings_save(AppState *app_state, uint32_t now_millis);
+
+/**
+ * Save the settings once a requested save has been idle for SETTINGS_SAVE_DEBOUNCE_MILLIS.
+ *
+ *  Call this every frame, a burst of changes turns into a single write.
+ *
+ * Parameters:
+ *      app_state - state object to save settings from
+ *      now_millis - current time on the clock passed to request_settings_save
+ *
+ * Returns:
+ *      0 if nothing was due or the save succeeded, 1 on failure
+ */
+int save_settings_if_idle(AppState *app_state, uint32_t now_millis);
+
+/**
+ * Replace a file so a power cut leaves either the old or the new contents.
+ *
+ *  Writes a .tmp sibling, fsyncs it, renames it over path and syncs the
+ *  directory entry.
+ *
+ * Parameters:
+ *      path - file to replace
+ *      contents - new contents
+ *      length - number of bytes in contents
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int write_file_atomically(const char *path, const char *contents, size_t length);
+
+/**
+ * Sync the directory containing path so a rename into it survives a power cut.
+ *
+ * Parameters:
+ *      path - file whose directory entry changed
+ */
+void sync_parent_directory(const char *path);
+
+/**
+ * Continue a 64-bit FNV-1a hash, used to tell whether content changed.
+ *
+ * Parameters:
+ *      hash - CONTENT_HASH_SEED, or the result of a previous call
+ *      bytes - data to mix in
+ *      length - number of bytes
+ *
+ * Returns:
+ *      the updated hash
+ */
+uint64_t content_hash(uint64_t hash, const void *bytes, size_t length);
+
+/**
+ * Write one setting of one LED to its system file(s).
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *      led - LED to write the data for
+ *      field - which setting to write
+ *
+ * Returns:
+ *      void
+ */
+void write_led_setting_sys_file(const AppState *app_state, Led led, LedSettingField field);
+
+/**
+ * Write user selection data to the associated LED files.
+ *
+ *  Opens several files in the /sys/class/led_anim directory and writes
+ *  the user selected values to the files. The firmware continually
+ *  checks the values in this directory and updates the LEDs accordingly.
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *
+ * Returns:
+ *      void
+ */
+void update_leds(AppState *app_state);
+
+/**
+ * Write only the settings that changed since the last commit.
+ *
+ *  Same as update_leds, but skips every file whose value is already in
+ *  place, so a single button press costs one or two writes instead of 15.
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *
+ * Returns:
+ *      void
+ */
+void commit_dirty_leds(AppState *app_state);
+
+/**
+ * Find the schema field a config page row edits.
+ *
+ * Parameters:
+ *      option - config page row
+ *
+ * Returns:
+ *      the matching field, LED_FIELD_COUNT for rows that aren't a setting (LED selection, sync)
+ */
+LedSettingField led_setting_field_for_option(LedSettingOption option);
+
+/**
+ * Read a setting by field index.
+ *
+ * Parameters:
+ *      settings - settings of one LED
+ *      field - which setting to read
+ *
+ * Returns:
+ *      the value as an int
+ */
+int get_led_setting(const LedSettings *settings, LedSettingField field);
+
+/**
+ * Write a setting by field index, clamped to the schema bounds.
+ *
+ *  Marks the field dirty when the value changes so commit_dirty_leds writes it.
+ *
+ * Parameters:
+ *      app_state - state object with the LED to change
+ *      led - LED to change
+ *      field - which setting to change
+ *      value - new value, clamped to the field's minimum and maximum
+ *
+ * Returns:
+ *      true if the stored value changed
+ */
+bool set_led_setting(AppState *app_state, Led led, LedSettingField field, int value);
+
+/**
+ * Finish persistence on exit without keeping the caller waiting.
+ *
+ *  Forks a detached worker that saves the settings and installs the daemon
+ *  (if should_install_daemon is set), so the caller can return to the
+ *  launcher right away. save_settings replaces the file atomically, so a
+ *  worker killed half way leaves the previous settings intact. Falls back
+ *  to doing the work inline if fork fails, and always works inline while
+ *  tracing so the save_settings and install_daemon spans are recorded.
+ *
+ * Parameters:
+ *      app_state - state to persist, copied into the worker by fork
+ *
+ * Returns:
+ *      0 if the work was handed off or finished, 1 if it failed inline
+ */
+int persist_settings_detached(AppState *app_state);
+
+/**
+ * Quick action that matches all LED colors to the current
+ *
+ * Parameters:
+ *      app_state - state object with user information we're updating.
+ *
+ * Returns:
+ *      void
+ */
+void color_match_leds(AppState *app_state);
+
+/**
+ * Write every LED's brightness file directly, without touching the settings.
+ *
+ *  Turning off also zeroes the effect files so the firmware picks the change up.
+ *  Used by the menu's enable/disable all and by --launch after an uninstall.
+ *
+ * Parameters:
+ *      is_on - true for full brightness, false to turn every LED off
+ *
+ * Returns:
+ *      0 on success, 1 if a file couldn't be written
+ */
+int write_all_leds_power(bool is_on);
+
+/**
+ * Turn off all LEDs.
+ *
+ * Parameters:
+ *      app_state - state object with led information that must be updated.
+ *
+ * Returns:
+ *      void
+ */
+void turn_off_all_leds(AppState *app_state);
+
+/**
+ * Turn on all LEDs.
+ *
+ * Parameters:
+ *      app_state - state object with led information that must be updated.
+ *
+ * Returns:
+ *      void
+ */
+void turn_on_all_leds(AppState *app_state);
+
+/**
+ * Add or remove write access on every file in the LED system directory.
+ *
+ *  The firmware leaves the LED files read-only, the daemon opens them up
+ *  before committing settings and locks them again afterwards.
+ *
+ * Parameters:
+ *      writable - true to add write access for everyone, false to remove it
+ *
+ * Returns:
+ *      0 on success, 1 if the directory couldn't be read or a file couldn't be changed
+ */
+int set_led_sys_files_writable(bool writable);
+
+#endif
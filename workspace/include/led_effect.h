@@ -0,0 +1,45 @@
+#ifndef LED_EFFECT_H
+#define LED_EFFECT_H
+
+#include "led_core.h"
+#include <stdint.h>
+
+/* Samples per effect period in the intensity tables */
+#define LED_EFFECT_TABLE_SIZE 256
+
+/**
+ * How bright an LED running an effect is at a point in its cycle.
+ *
+ *  Each effect's curve is sampled once into a lookup table, so this is an
+ *  index and a load. The curves model what /sys/class/led_anim does for
+ *  each effect over one period of duration milliseconds:
+ *   LINEAR - ramps up over the first half and down over the second
+ *   BREATH - the same, eased in and out
+ *   SNIFF - quick rise, slow fade
+ *   BLINK1-3 - one to three short flashes, then dark for the rest of the period
+ *   STATIC - always on, DISABLE - always off
+ *  A duration of 0 holds the effect at full intensity, except DISABLE.
+ *
+ * Parameters:
+ *      effect - effect the LED runs
+ *      duration_millis - length of one effect period
+ *      elapsed_millis - time since the effect started
+ *
+ * Returns:
+ *      intensity from 0 (off) to 255 (full)
+ */
+uint8_t led_effect_intensity(AnimationEffect effect, int duration_millis, uint32_t elapsed_millis);
+
+/**
+ * The color an LED shows, its color scaled by brightness and the effect intensity.
+ *
+ * Parameters:
+ *      settings - LED settings to simulate
+ *      elapsed_millis - time since the effect started
+ *
+ * Returns:
+ *      0xRRGGBB color
+ */
+uint32_t led_effect_color(const LedSettings *settings, uint32_t elapsed_millis);
+
+#endif
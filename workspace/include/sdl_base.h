@@ -5,17 +5,102 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 #include <stdbool.h>
+#include "input_type.h"
+#include "asset_pack.h"
+#include "sprite_atlas.h"
+/* Most quads a RenderBatch queues before it has to submit them. */
+#define RENDER_BATCH_QUAD_CAPACITY 256
+/* How long probe_fastest_renderer renders with each render driver */
+#define RENDERER_PROBE_MILLIS 40
+/* Hold-to-repeat timing for controller buttons, see ButtonRepeat */
+#define BUTTON_REPEAT_DELAY_MILLIS 400
+#define BUTTON_REPEAT_INTERVAL_MILLIS 120
+#define BUTTON_REPEAT_MIN_INTERVAL_MILLIS 30
+#define BUTTON_REPEAT_ACCELERATION_PERCENT 15
+/* Left stick travel (out of 32767) ignored around the center, see AnalogStick */
+#define ANALOG_STICK_DEADZONE 8000
+/* Steps per second with the stick pushed all the way over a discrete setting (LED, effect, duration) */
+#define ANALOG_STICK_MAX_STEPS_PER_SECOND 30
+/* Longest frame gap the stick integrates over, a stalled frame must not jump the value */
+#define ANALOG_STICK_MAX_FRAME_MILLIS 100
+/* Most textures and surfaces the resource accounting follows at once */
+#define TRACKED_RESOURCE_CAPACITY 1024
+
+/* One rectangle queued in a RenderBatch. */
+typedef struct
+{
+    /* Texture pixels to copy, unused for solid color quads */
+    SDL_Rect source;
+    SDL_Rect destination;
+    SDL_Color color;
+} RenderBatchQuad;
+
+/* Queues textured and solid quads and submits each run that shares a texture
+ * as one SDL_RenderGeometry call, instead of one SDL_RenderCopy/SDL_RenderFillRect per quad.
+ *
+ * Draw order is kept, a quad with a different texture submits everything queued before it.
+ */
+typedef struct
+{
+    SDL_Renderer *renderer;
+    /* Used for quads drawn over the whole target (NULL destination) */
+    int target_width;
+    int target_height;
+    /* Texture of every queued quad, NULL while queueing solid color quads */
+    SDL_Texture *texture;
+    int texture_width;
+    int texture_height;
+    RenderBatchQuad quads[RENDER_BATCH_QUAD_CAPACITY];
+    int quad_count;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    /* SDL_RenderGeometry input, older SDL submits the quads one by one instead */
+    SDL_Vertex vertices[RENDER_BATCH_QUAD_CAPACITY * 4];
+    int indices[RENDER_BATCH_QUAD_CAPACITY * 6];
+#endif
+} RenderBatch;
+
+/* Snapshot of the resource accounting, filled by get_resource_counts.
+ *
+ * Textures and surfaces are counted when they go through track_texture and
+ * track_surface, which every creation helper in sdl_base does.
+ */
+typedef struct
+{
+    int live_textures;
+    int live_surfaces;
+    Uint64 live_texture_bytes;
+    Uint64 live_surface_bytes;
+    /* SDL_malloc/calloc/realloc calls since install_allocation_counter, wraps around, compare differences */
+    Uint32 allocation_count;
+    /* Allocations SDL and its libraries haven't freed yet, -1 if this SDL can't tell */
+    int live_allocation_count;
+} ResourceCounts;
+
 /* Struct to hold core SDL components
  *
  * Helps keep all SDL components in one place.
+ * Set headless before calling initialize_sdl_core to render into
+ * offscreen_surface with the software renderer instead of a window.
  */
 typedef struct
 {
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_GameController *controller;
+    SDL_Surface *offscreen_surface;
     int window_width;
     int window_height;
+    bool headless;
+    /* Keep images in 32 bit textures instead of the 16 bit formats picked by choose_texture_format */
+    bool full_color_textures;
+    /* Everything render_frame draws goes through this batch, set up by initialize_sdl_core */
+    RenderBatch render_batch;
+    /* Render driver to use, i.e "opengles2" or "software", NULL lets SDL pick an accelerated one */
+    const char *requested_renderer;
+    /* Time every render driver with probe_fastest_renderer and use the fastest, overrides requested_renderer */
+    bool should_probe_renderer;
+    /* Name of the render driver in use, set by initialize_sdl_core */
+    const char *renderer_name;
 } CoreSDLComponents;
 
 /* Abstraction of what frames relate to a particular animation.
@@ -47,34 +132,79 @@ typedef struct
     int current_animation_index;
     int sprite_width;
     int sprite_height;
+    /* Frame layout inside sprite_texture when it is a tile atlas, zeroed for a horizontal strip */
+    SpriteAtlas atlas;
 } Sprite;
 
-/* Used to convert SDL inputs to a common input definition.
+/* Magic bytes at the start of every input recording, followed by a version byte. */
+#define INPUT_RECORDING_MAGIC "LEDI"
+#define INPUT_RECORDING_VERSION 1
+
+/* A single input and the time it arrived, relative to the start of the session.
  *
- * Useful in the case of accepting both keyboard and controller inputs.
+ * An UNKNOWN input marks the end of a recorded session.
  */
-typedef enum
+typedef struct
 {
-    UNKNOWN,
-    START,
-    SELECT,
-    MENU,
-    POWER,
-    DPAD_LEFT,
-    DPAD_RIGHT,
-    DPAD_UP,
-    DPAD_DOWN,
-    A,
-    B,
-    X,
-    Y,
-    L1,
-    R1,
-    L2,
-    R2,
-    L3,
-    R3,
-} InputType;
+    Uint32 timestamp_millis;
+    InputType input;
+} RecordedInput;
+
+/* Appends inputs to a compact binary log.
+ *
+ * Each record is the milliseconds since the previous record as an unsigned
+ * LEB128 varint followed by one InputType byte, so most records take 2 bytes.
+ */
+typedef struct
+{
+    FILE *file;
+    Uint32 start_millis;
+    Uint32 last_timestamp_millis;
+} InputRecorder;
+
+/* Cursor over a list of recorded inputs that hands them out once they're due. */
+typedef struct
+{
+    const RecordedInput *inputs;
+    int input_count;
+    int next_input_index;
+} InputPlayback;
+
+/* Turns a held controller button into repeated inputs.
+ *
+ * SDL only repeats keyboard keys, a held D-pad or shoulder button sends a single
+ * SDL_CONTROLLERBUTTONDOWN. The first repeat comes delay_millis after the press,
+ * then every interval, which shrinks by acceleration_percent per repeat down to
+ * minimum_interval_millis.
+ */
+typedef struct
+{
+    Uint32 delay_millis;
+    Uint32 initial_interval_millis;
+    Uint32 minimum_interval_millis;
+    int acceleration_percent;
+    /* Button being held and the input it repeats, UNKNOWN when nothing repeats */
+    Uint8 held_button;
+    InputType held_input;
+    Uint32 next_repeat_millis;
+    Uint32 interval_millis;
+} ButtonRepeat;
+
+/* Turns the left stick's horizontal axis into a steady stream of steps.
+ *
+ * Axis events only update the latest position, however many arrive. Once per
+ * frame analog_stick_steps turns that position into a rate, squared past the
+ * deadzone so small deflections give fine control, and integrates it over the
+ * time since the last frame.
+ */
+typedef struct
+{
+    int deadzone;
+    Sint16 x_value;
+    /* Fraction of a step carried between frames, in thousandths of a step */
+    int step_remainder;
+    Uint32 last_update_millis;
+} AnalogStick;
 
 /**
  * Handles the initialization of common SDL components necessary for every app
@@ -89,6 +219,37 @@ typedef enum
  */
 int initialize_sdl_core(CoreSDLComponents *core_components, char *window_title);
 
+/**
+ * Find the fastest render driver for a window.
+ *
+ *  Creates a renderer with each available driver in turn and draws a frame
+ *  shaped like the UI (a full screen image, two rectangles, ~120 sprite tiles
+ *  and six text lines) for RENDERER_PROBE_MILLIS, then destroys it.
+ *
+ * Parameters:
+ *      window - window to create the probe renderers for, it has no renderer yet
+ *      width - width of the frame to draw
+ *      height - height of the frame to draw
+ *
+ * Returns:
+ *      name of the fastest driver, owned by SDL, or NULL if no driver could render
+ */
+const char *probe_fastest_renderer(SDL_Window *window, int width, int height);
+
+/**
+ * Save the current contents of the renderer to a PNG file.
+ *
+ *  Used to dump headless frames for golden-image comparison.
+ *
+ * Parameters:
+ *      core_components - initialized core SDL components to read from
+ *      png_path - path of the PNG file to write
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int save_frame_to_png(CoreSDLComponents *core_components, const char *png_path);
+
 /**
  * Frees the core SDL components.
  *
@@ -101,6 +262,8 @@ void free_sdl_core(CoreSDLComponents *core_components);
 /**
  * Frees the sprite object.
  *
+ *  Destroys the texture and the atlas. The animations belong to whoever set up the sprite.
+ *
  * Parameters:
  *     sprite - The sprite object to free
  */
@@ -112,21 +275,62 @@ void free_sprite(Sprite *sprite);
  *  Works by selecting the correct section of the sprite sheet to render and
  *  applying that to a SDL_Rect which is copies to the renderer at the chosen
  *  position. If enough time has elapsed, the frame index is updated to the next
- *  frame in the animation. As with all Sprite Objects, we expect the sprite to be
- *  a horizontal sprite sheet.
+ *  frame in the animation. Sprites are expected to be a horizontal sprite sheet,
+ *  unless sprite->atlas is loaded, then each frame is assembled from its atlas tiles.
  *
  *  Note: Animation index is expected to be set before calling this function.
  *
  * Parameters:
- *      renderer - SDL renderer to draw to.
+ *      batch - render batch to queue the sprite's quads in
  *      sprite - SDL surface containing the sprite sheet
  *      position_x - x position to render the sprite
  *      position_y - y position to render the sprite
+ *      now_millis - frame clock the animation advances on, the replay clock in replays and headless runs
  *
  *  Returns:
  *     void
  */
-void update_sprite_render(SDL_Renderer *renderer, Sprite *sprite, int position_x, int position_y);
+void update_sprite_render(RenderBatch *batch, Sprite *sprite, int position_x, int position_y, Uint32 now_millis);
+
+/**
+ * Prepare an empty render batch.
+ *
+ * Parameters:
+ *      batch - batch to initialize
+ *      renderer - renderer the batch submits to
+ *      target_width - width of the render target
+ *      target_height - height of the render target
+ */
+void render_batch_init(RenderBatch *batch, SDL_Renderer *renderer, int target_width, int target_height);
+
+/**
+ * Queue a copy of part of a texture, like SDL_RenderCopy.
+ *
+ * Parameters:
+ *      batch - batch to queue in
+ *      texture - texture to copy from
+ *      source - texture pixels to copy, NULL for the whole texture
+ *      destination - where to draw, NULL for the whole target
+ */
+void render_batch_copy(RenderBatch *batch, SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *destination);
+
+/**
+ * Queue a solid color rectangle, like SDL_RenderFillRect with the renderer's draw blend mode.
+ *
+ * Parameters:
+ *      batch - batch to queue in
+ *      rect - rectangle to fill
+ *      color - fill color
+ */
+void render_batch_fill_rect(RenderBatch *batch, const SDL_Rect *rect, SDL_Color color);
+
+/**
+ * Submit every queued quad. Call before SDL_RenderPresent or reading the target back.
+ *
+ * Parameters:
+ *      batch - batch to submit
+ */
+void render_batch_flush(RenderBatch *batch);
 
 /**
  * Converts an SDL event to an InputType to simplify input handling
@@ -154,6 +358,146 @@ InputType sdl_event_to_input_type(SDL_Event *event, bool verbose);
  */
 SDL_Texture *create_sdl_texture_from_image(SDL_Renderer *renderer, const char *full_image_path);
 
+/**
+ * Upload a decoded image to an SDL texture.
+ *
+ *  Must run on the render thread, decoding can happen anywhere.
+ *
+ * Parameters:
+ *      renderer - The SDL renderer to create the texture with
+ *      surface - Decoded image, freed by this call
+ *
+ * Returns:
+ *      SDL_Texture pointer containing the image, NULL on failure.
+ */
+SDL_Texture *create_sdl_texture_from_surface(SDL_Renderer *renderer, SDL_Surface *surface);
+
+/**
+ * Classify how a decoded image uses its alpha channel.
+ *
+ *  Scans every pixel of 32 bit images, other alpha formats are reported as blended.
+ *
+ * Parameters:
+ *      surface - decoded image
+ *
+ * Returns:
+ *      IMAGE_ALPHA_OPAQUE, IMAGE_ALPHA_BINARY or IMAGE_ALPHA_BLENDED
+ */
+ImageAlphaType get_surface_alpha_type(SDL_Surface *surface);
+
+/**
+ * Pick the smallest texture format the renderer supports that can hold an image.
+ *
+ *  Opaque images prefer RGB565, then RGB888, so they are never alpha blended.
+ *  Images whose pixels are fully opaque or fully transparent prefer ARGB1555,
+ *  then ARGB4444. Anything else, or a renderer without 16 bit formats, gets ARGB8888.
+ *
+ * Parameters:
+ *      renderer - renderer whose texture formats are queried
+ *      alpha_type - how the image uses alpha
+ *      allow_16_bit - false keeps 32 bit formats, i.e for comparing frame dumps
+ *
+ * Returns:
+ *      SDL_PIXELFORMAT_* value to create the texture with
+ */
+Uint32 choose_texture_format(SDL_Renderer *renderer, ImageAlphaType alpha_type, bool allow_16_bit);
+
+/**
+ * Upload a decoded image to a texture of the given format.
+ *
+ *  The surface is converted first when its format differs. Formats without
+ *  alpha are drawn with blending disabled.
+ *
+ * Parameters:
+ *      renderer - The SDL renderer to create the texture with
+ *      surface - Decoded image, freed by this call
+ *      texture_format - format from choose_texture_format
+ *
+ * Returns:
+ *      SDL_Texture pointer containing the image, NULL on failure.
+ */
+SDL_Texture *create_sdl_texture_in_format(SDL_Renderer *renderer, SDL_Surface *surface, Uint32 texture_format);
+
+/**
+ * Number of bytes of pixel storage a texture needs.
+ *
+ * Parameters:
+ *      texture - texture to measure, may be NULL
+ *
+ * Returns:
+ *      width * height * bytes per pixel of the texture format, 0 for NULL
+ */
+size_t get_texture_byte_count(SDL_Texture *texture);
+
+/**
+ * Map an asset pack written by make asset_pack.
+ *
+ * Parameters:
+ *      pack - pack object to fill in
+ *      pack_path - path to the .pack file
+ *
+ * Returns:
+ *      0 on success, 1 if the file is missing or isn't a valid pack (callers fall back to PNGs)
+ */
+int open_asset_pack(AssetPack *pack, const char *pack_path);
+
+/**
+ * Unmap an asset pack. Textures created from it stay valid.
+ *
+ * Parameters:
+ *      pack - pack opened with open_asset_pack, safe to pass after a failed open
+ */
+void close_asset_pack(AssetPack *pack);
+
+/**
+ * Find an image in an asset pack.
+ *
+ * Parameters:
+ *      pack - pack opened with open_asset_pack
+ *      image_path - image path, only the file name is compared
+ *
+ * Returns:
+ *      the entry, or NULL if the pack doesn't hold this image
+ */
+const AssetPackEntry *find_asset_pack_entry(const AssetPack *pack, const char *image_path);
+
+/**
+ * Create a texture straight from predecoded pack pixels.
+ *
+ *  When texture_format matches the pack's pixel format the pixels are
+ *  uploaded from the mapping as is, otherwise they are converted once.
+ *
+ * Parameters:
+ *      renderer - The SDL renderer to create the texture with
+ *      pack - pack the entry belongs to
+ *      entry - image to upload
+ *      texture_format - texture format, entry->pixel_format for a zero copy upload
+ *
+ * Returns:
+ *      SDL_Texture pointer containing the image, NULL on failure.
+ */
+SDL_Texture *create_sdl_texture_from_asset_pack(SDL_Renderer *renderer, const AssetPack *pack, const AssetPackEntry *entry, Uint32 texture_format);
+
+/**
+ * Load the index written next to a sprite atlas by make sprite_atlas.
+ *
+ * Parameters:
+ *      atlas - atlas object to fill in, free it with free_sprite_atlas
+ *      index_path - path to the .index file
+ *
+ * Returns:
+ *      0 on success, 1 if the file is missing or isn't a valid index (callers fall back to the strip)
+ */
+int load_sprite_atlas(SpriteAtlas *atlas, const char *index_path);
+
+/**
+ * Free the frames and placements of a sprite atlas.
+ *
+ * Parameters:
+ *      atlas - atlas loaded with load_sprite_atlas, safe to pass after a failed load
+ */
+void free_sprite_atlas(SpriteAtlas *atlas);
+
 /**
  * Create a text texture from a string.
  *
@@ -169,6 +513,243 @@ SDL_Texture *create_sdl_texture_from_image(SDL_Renderer *renderer, const char *f
  */
 SDL_Texture *create_text_texture(SDL_Renderer *renderer, TTF_Font *font, const SDL_Color *text_color, const SDL_Color *shadow_color, const char *text);
 
+/**
+ * Gets the number of textures created by create_sdl_texture_from_image/surface and create_text_texture.
+ *
+ * Returns:
+ *      Total textures created since the application started
+ */
+Uint64 get_textures_created_count(void);
+
+/**
+ * Gets the number of draw calls submitted by render batches.
+ *
+ * Returns:
+ *      Total draw calls since the application started
+ */
+Uint64 get_draw_call_count(void);
+
+/**
+ * Count a new texture as live until destroy_texture.
+ *
+ * Parameters:
+ *      texture - texture that was just created, NULL is ignored
+ *      site - where it was created, i.e __func__, grouped by log_live_resources
+ *
+ * Returns:
+ *      texture, so creation calls can be wrapped directly
+ */
+SDL_Texture *track_texture(SDL_Texture *texture, const char *site);
+
+/**
+ * Destroy a texture and stop counting it.
+ *
+ * Parameters:
+ *      texture - texture to destroy, may be NULL or untracked
+ */
+void destroy_texture(SDL_Texture *texture);
+
+/**
+ * Count a new surface as live until free_surface.
+ *
+ *  Safe to call from worker threads.
+ *
+ * Parameters:
+ *      surface - surface that was just created, NULL is ignored
+ *      site - where it was created, i.e __func__, grouped by log_live_resources
+ *
+ * Returns:
+ *      surface, so creation calls can be wrapped directly
+ */
+SDL_Surface *track_surface(SDL_Surface *surface, const char *site);
+
+/**
+ * Free a surface and stop counting it.
+ *
+ * Parameters:
+ *      surface - surface to free, may be NULL or untracked
+ */
+void free_surface(SDL_Surface *surface);
+
+/**
+ * Count every allocation SDL, SDL_image and SDL_ttf make through SDL_malloc.
+ *
+ *  Only SDL's allocator is hooked. FreeType, libpng and the app's own code
+ *  allocate with libc malloc, so their heap traffic isn't counted.
+ *  Must be called before anything else in SDL, it swaps SDL's memory functions.
+ *  Does nothing on SDL older than 2.0.7.
+ */
+void install_allocation_counter(void);
+
+/**
+ * Read the live texture, surface and allocation counts.
+ *
+ * Parameters:
+ *      counts - filled with the current counts
+ */
+void get_resource_counts(ResourceCounts *counts);
+
+/**
+ * Print the live textures and surfaces grouped by the site that created them.
+ */
+void log_live_resources(void);
+
+/**
+ * Gets the number of events the event filter kept out of SDL's queue.
+ *
+ * Returns:
+ *      Total events dropped since initialize_sdl_core, wraps around
+ */
+Uint32 get_events_dropped_count(void);
+
+/**
+ * Sample how many events are waiting in SDL's queue, call after SDL_PumpEvents.
+ */
+void note_event_queue_depth(void);
+
+/**
+ * Gets the deepest SDL event queue seen by note_event_queue_depth.
+ *
+ * Returns:
+ *      Most events that were waiting at once
+ */
+int get_max_event_queue_depth(void);
+
+/**
+ * Open an input recording for writing.
+ *
+ * Parameters:
+ *      recorder - recorder object to initialize
+ *      recording_path - path of the binary log to create
+ *      start_millis - SDL_GetTicks() value all timestamps are relative to
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int input_recorder_open(InputRecorder *recorder, const char *recording_path, Uint32 start_millis);
+
+/**
+ * Append an input to an open recording.
+ *
+ * Parameters:
+ *      recorder - recorder opened with input_recorder_open
+ *      input - the input to record, UNKNOWN inputs are ignored
+ *      now_millis - SDL_GetTicks() value when the input arrived
+ */
+void input_recorder_write(InputRecorder *recorder, InputType input, Uint32 now_millis);
+
+/**
+ * Write the end of session marker and close the recording.
+ *
+ * Parameters:
+ *      recorder - recorder opened with input_recorder_open
+ *      now_millis - SDL_GetTicks() value when the session ended
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int input_recorder_close(InputRecorder *recorder, Uint32 now_millis);
+
+/**
+ * Load an input recording written by InputRecorder.
+ *
+ * Parameters:
+ *      recording_path - path of the binary log to read
+ *      inputs - array to load the inputs into
+ *      capacity - maximum number of inputs the array can hold
+ *
+ * Returns:
+ *      number of inputs loaded (including the end of session marker), -1 on failure
+ */
+int load_input_recording(const char *recording_path, RecordedInput *inputs, int capacity);
+
+/**
+ * Get the next input that is due at a point in the session.
+ *
+ *  Call in a loop each frame until it returns false to drain every due input.
+ *
+ * Parameters:
+ *      playback - playback cursor
+ *      clock_millis - current session time
+ *      input - set to the due input
+ *
+ * Returns:
+ *      true if an input was due, false otherwise
+ */
+bool next_due_input(InputPlayback *playback, Uint32 clock_millis, InputType *input);
+
+/**
+ * Set up hold-to-repeat with nothing held.
+ *
+ * Parameters:
+ *      repeat - repeat state to initialize
+ *      delay_millis - time a button is held before it starts repeating
+ *      acceleration_percent - how much shorter each repeat interval is than the last (0 for a fixed rate)
+ */
+void button_repeat_init(ButtonRepeat *repeat, Uint32 delay_millis, int acceleration_percent);
+
+/**
+ * Start or stop repeating a button from a controller event.
+ *
+ *  Call for every polled event, including ones is_supported_input_event rejects,
+ *  so button releases are seen. Only navigation inputs (D-pad, L1, R1) repeat,
+ *  pressing another button stops the current repeat.
+ *
+ * Parameters:
+ *      repeat - repeat state
+ *      event - polled SDL event
+ *      now_millis - SDL_GetTicks() value when the event was polled
+ */
+void button_repeat_track(ButtonRepeat *repeat, const SDL_Event *event, Uint32 now_millis);
+
+/**
+ * Get the repeat of the held button if one is due.
+ *
+ *  Returns at most one repeat per call, a stalled frame delays repeats instead of bunching them up.
+ *
+ * Parameters:
+ *      repeat - repeat state
+ *      now_millis - current SDL_GetTicks() value
+ *      input - set to the repeated input
+ *
+ * Returns:
+ *      true if a repeat was due, false otherwise
+ */
+bool next_repeated_input(ButtonRepeat *repeat, Uint32 now_millis, InputType *input);
+
+/**
+ * Set up the analog stick at rest.
+ *
+ * Parameters:
+ *      stick - stick state to initialize
+ *      deadzone - axis travel (out of 32767) ignored around the center
+ */
+void analog_stick_init(AnalogStick *stick, int deadzone);
+
+/**
+ * Record the stick position from a polled event.
+ *
+ *  Call for every polled event, SDL_CONTROLLERAXISMOTION isn't a supported input event.
+ *
+ * Parameters:
+ *      stick - stick state
+ *      event - polled SDL event
+ */
+void analog_stick_track(AnalogStick *stick, const SDL_Event *event);
+
+/**
+ * Steps the stick has moved since the last call, call once per frame.
+ *
+ * Parameters:
+ *      stick - stick state
+ *      now_millis - current SDL_GetTicks() value
+ *      max_steps_per_second - step rate with the stick fully pushed, may change between frames
+ *
+ * Returns:
+ *      whole steps to take, negative when the stick is pushed left
+ */
+int analog_stick_steps(AnalogStick *stick, Uint32 now_millis, int max_steps_per_second);
+
 /**
  * Checks if an SDL event is supported by the input handling system
  *
@@ -191,6 +772,17 @@ bool is_supported_input_event(Uint32 event_type);
  */
 const char *get_input_type_name(Uint32 inputType);
 
+/**
+ * Converts a name returned by get_input_type_name back to its InputType
+ *
+ * Parameters:
+ *      name - The input type name (i.e "DPAD_RIGHT")
+ *
+ * Returns:
+ *      The matching InputType, UNKNOWN if the name isn't recognized
+ */
+InputType input_type_from_name(const char *name);
+
 /**
  * Gets the name of an SDL event type
  *
@@ -0,0 +1,57 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <stdint.h>
+
+/* "LDAT" read as a little endian uint32_t */
+#define SPRITE_ATLAS_MAGIC 0x5441444Cu
+#define SPRITE_ATLAS_VERSION 1
+
+/*
+ * Index written next to the atlas image by tools/pack_sprite_atlas.c:
+ *  SpriteAtlasHeader
+ *  SpriteAtlasFrame[frame_count]
+ *  SpriteAtlasPlacement[placement_count]
+ *
+ * A frame is drawn by copying each of its placements from the atlas to
+ * (frame_x, frame_y) inside the frame. Fully transparent tiles have no
+ * placement and identical tiles share one atlas region.
+ */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint16_t frame_width;
+  uint16_t frame_height;
+  uint32_t frame_count;
+  uint32_t placement_count;
+} SpriteAtlasHeader;
+
+typedef struct
+{
+  uint32_t first_placement;
+  uint32_t placement_count;
+} SpriteAtlasFrame;
+
+typedef struct
+{
+  uint16_t atlas_x;
+  uint16_t atlas_y;
+  uint16_t frame_x;
+  uint16_t frame_y;
+  uint16_t width;
+  uint16_t height;
+} SpriteAtlasPlacement;
+
+/* An index loaded with load_sprite_atlas, frames is NULL when a sprite uses a plain strip. */
+typedef struct
+{
+  SpriteAtlasFrame *frames;
+  SpriteAtlasPlacement *placements;
+  uint32_t frame_count;
+  uint32_t placement_count;
+  int frame_width;
+  int frame_height;
+} SpriteAtlas;
+
+#endif
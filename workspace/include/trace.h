@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of span events (begin and end each count once) kept per session. */
+#define TRACE_EVENT_CAPACITY 65536
+
+/* A single begin ('B') or end ('E') marker in the Chrome trace-event format. */
+typedef struct
+{
+    const char *name;
+    uint64_t timestamp_nanos;
+    uint32_t thread_id;
+    char phase;
+    /* Set with a release store once the fields above are written, trace_write skips slots without it */
+    bool is_ready;
+} TraceEvent;
+
+/**
+ * Enable tracing and preallocate the event buffer.
+ *
+ *  Nothing is recorded until this is called, so the span calls are
+ *  free to leave in place for normal launches.
+ *
+ * Parameters:
+ *      output_path - file the Chrome trace-event JSON is written to by trace_write
+ *
+ * Returns:
+ *      0 on success, 1 on failure
+ */
+int trace_initialize(const char *output_path);
+
+/**
+ * Check if a trace is being recorded.
+ *
+ * Returns:
+ *      true if trace_initialize succeeded and trace_write hasn't run yet
+ */
+bool trace_is_enabled(void);
+
+/**
+ * Record the start of a span.
+ *
+ *  Safe to call from any thread. Never allocates or performs I/O, events
+ *  recorded after the buffer fills are counted and dropped.
+ *
+ * Parameters:
+ *      name - span name, must be a string literal (or otherwise outlive the trace)
+ */
+void trace_begin(const char *name);
+
+/**
+ * Record the end of a span started with trace_begin.
+ *
+ * Parameters:
+ *      name - span name, must match the name passed to trace_begin
+ */
+void trace_end(const char *name);
+
+/**
+ * Serialize all recorded events to the output path as Chrome trace-event JSON
+ * and release the event buffer. Open the file in Perfetto or chrome://tracing.
+ *
+ * Returns:
+ *      0 on success (or if tracing was never enabled), 1 on failure
+ */
+int trace_write(void);
+
+#endif
@@ -0,0 +1,73 @@
+#include "embedded_assets.h"
+#include "led_controller_common.h"
+#include <string.h>
+
+#ifdef EMBED_ASSETS
+
+/* Paths given to .incbin are relative to the directory make runs in. */
+#define EMBED_ASSET_FILE(symbol, file_path)                     \
+    __asm__(".section .rodata\n"                                \
+            ".global " #symbol "\n"                             \
+            ".balign 16\n" #symbol ":\n"                        \
+            ".incbin \"" file_path "\"\n"                       \
+            ".global " #symbol "_end\n" #symbol "_end:\n"       \
+            ".previous\n");                                     \
+    extern const unsigned char symbol[];                        \
+    extern const unsigned char symbol##_end[];
+
+EMBED_ASSET_FILE(embedded_background_image, "workspace/" BACKGROUND_IMAGE_PATH)
+EMBED_ASSET_FILE(embedded_menu_image, "workspace/" MENU_IMAGE_PATH)
+EMBED_ASSET_FILE(embedded_brick_sprite_sheet, "workspace/" BRICK_SPRITE_SHEET_PATH)
+EMBED_ASSET_FILE(embedded_font, "workspace/" FONT_PATH)
+
+/* A file linked in above and the path it would otherwise be opened from. */
+typedef struct
+{
+    const char *path;
+    const unsigned char *start;
+    const unsigned char *end;
+} EmbeddedAsset;
+
+static const EmbeddedAsset embedded_assets[] = {
+    {BACKGROUND_IMAGE_PATH, embedded_background_image, embedded_background_image_end},
+    {MENU_IMAGE_PATH, embedded_menu_image, embedded_menu_image_end},
+    {BRICK_SPRITE_SHEET_PATH, embedded_brick_sprite_sheet, embedded_brick_sprite_sheet_end},
+    {FONT_PATH, embedded_font, embedded_font_end},
+};
+
+bool are_assets_embedded(void)
+{
+    return true;
+}
+
+bool find_embedded_asset(const char *path, const unsigned char **data, size_t *size)
+{
+    for (size_t asset_index = 0; asset_index < sizeof(embedded_assets) / sizeof(embedded_assets[0]); asset_index++)
+    {
+        const EmbeddedAsset *asset = &embedded_assets[asset_index];
+        if (strcmp(asset->path, path) == 0)
+        {
+            *data = asset->start;
+            *size = asset->end - asset->start;
+            return true;
+        }
+    }
+    return false;
+}
+
+#else
+
+bool are_assets_embedded(void)
+{
+    return false;
+}
+
+bool find_embedded_asset(const char *path, const unsigned char **data, size_t *size)
+{
+    (void)path;
+    (void)data;
+    (void)size;
+    return false;
+}
+
+#endif
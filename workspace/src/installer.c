@@ -0,0 +1,395 @@
+/* copy_file_range and sendfile are Linux extensions. */
+#define _GNU_SOURCE
+#include "installer.h"
+#include "led_core.h"
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Everything install.sh used to do, in order. Uninstall walks it backwards. */
+static const InstallEntry install_manifest[] = {
+    {INSTALL_COPY, INSTALL_ALWAYS, NULL, INSTALLED_SETTINGS_FILE, 0644, NULL},
+    {INSTALL_COPY, INSTALL_ALWAYS, "led_settings_daemon", INSTALL_SERVICE_DIRECTORY "/led_settings_daemon", 0755, NULL},
+    {INSTALL_COPY, INSTALL_ALWAYS, "service/led-settings-daemon", INSTALLED_INIT_SCRIPT, 0755, NULL},
+    /* The links "/etc/init.d/led-settings-daemon enable" creates for START=98 and STOP=99. */
+    {INSTALL_SYMLINK, INSTALL_ALWAYS, "../init.d/led-settings-daemon", "/etc/rc.d/S98led-settings-daemon", 0, NULL},
+    {INSTALL_SYMLINK, INSTALL_ALWAYS, "../init.d/led-settings-daemon", "/etc/rc.d/K99led-settings-daemon", 0, NULL},
+    {INSTALL_COPY, INSTALL_IF_LOW_BATTERY_INDICATION, "service/led_controller_low_battery_led.sh",
+     INSTALL_SERVICE_DIRECTORY "/led_controller_low_battery_led.sh", 0755, NULL},
+    {INSTALL_SYMLINK, INSTALL_IF_LOW_BATTERY_INDICATION, INSTALL_SERVICE_DIRECTORY "/led_controller_low_battery_led.sh",
+     STOCK_LOW_BATTERY_SCRIPT, 0, STOCK_LOW_BATTERY_BACKUP},
+};
+#define INSTALL_MANIFEST_LENGTH (sizeof(install_manifest) / sizeof(install_manifest[0]))
+
+/* Records read from and written back to INSTALLED_MANIFEST_FILE. */
+typedef struct
+{
+    InstalledFileRecord records[INSTALL_MANIFEST_CAPACITY];
+    int count;
+    bool changed;
+} InstalledManifest;
+
+static void load_installed_manifest(InstalledManifest *manifest)
+{
+    manifest->count = 0;
+    manifest->changed = false;
+    FILE *file = fopen(INSTALLED_MANIFEST_FILE, "r");
+    if (!file)
+    {
+        return;
+    }
+
+    InstalledFileRecord *record = &manifest->records[0];
+    unsigned long long hash;
+    while (manifest->count < INSTALL_MANIFEST_CAPACITY &&
+           fscanf(file, "%255s %lld %lld %ld %llx", record->destination, &record->size, &record->modified_seconds,
+                  &record->modified_nanoseconds, &hash) == 5)
+    {
+        record->content_hash = hash;
+        record = &manifest->records[++manifest->count];
+    }
+    fclose(file);
+}
+
+static int save_installed_manifest(const InstalledManifest *manifest)
+{
+    char text[INSTALL_MANIFEST_CAPACITY * (STRING_LENGTH + 64)];
+    size_t length = 0;
+    for (int record_index = 0; record_index < manifest->count; record_index++)
+    {
+        const InstalledFileRecord *record = &manifest->records[record_index];
+        length += snprintf(text + length, sizeof(text) - length, "%s %lld %lld %ld %016llx\n", record->destination, record->size,
+                           record->modified_seconds, record->modified_nanoseconds, (unsigned long long)record->content_hash);
+    }
+    return write_file_atomically(INSTALLED_MANIFEST_FILE, text, length);
+}
+
+static InstalledFileRecord *find_installed_record(InstalledManifest *manifest, const char *destination)
+{
+    for (int record_index = 0; record_index < manifest->count; record_index++)
+    {
+        if (strcmp(manifest->records[record_index].destination, destination) == 0)
+        {
+            return &manifest->records[record_index];
+        }
+    }
+    return NULL;
+}
+
+static void forget_installed_record(InstalledManifest *manifest, const char *destination)
+{
+    InstalledFileRecord *record = find_installed_record(manifest, destination);
+    if (record != NULL)
+    {
+        *record = manifest->records[--manifest->count];
+        manifest->changed = true;
+    }
+}
+
+static int hash_file(const char *path, uint64_t *hash)
+{
+    int file_descriptor = open(path, O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        perror("open");
+        return 1;
+    }
+    char buffer[4096];
+    ssize_t bytes_read;
+    *hash = CONTENT_HASH_SEED;
+    while ((bytes_read = read(file_descriptor, buffer, sizeof(buffer))) > 0)
+    {
+        *hash = content_hash(*hash, buffer, (size_t)bytes_read);
+    }
+    close(file_descriptor);
+    return bytes_read < 0 ? 1 : 0;
+}
+
+/* mkdir -p for the single missing level install.sh relied on (i.e /etc/led_controller). */
+static void create_parent_directory(const char *path)
+{
+    char directory_path[STRING_LENGTH];
+    const char *last_slash = strrchr(path, '/');
+    if (last_slash == NULL || last_slash == path)
+    {
+        return;
+    }
+    snprintf(directory_path, sizeof(directory_path), "%.*s", (int)(last_slash - path), path);
+    if (mkdir(directory_path, 0755) != 0 && errno != EEXIST)
+    {
+        perror("mkdir");
+    }
+}
+
+/* Copy size bytes in the kernel. copy_file_range can't cross filesystems on
+ * older kernels (the pak lives on the SD card), so fall back to sendfile, then
+ * to plain reads and writes. */
+static int copy_file_contents(int source_descriptor, int destination_descriptor, off_t size)
+{
+    off_t copied = 0;
+    while (copied < size)
+    {
+        ssize_t result = copy_file_range(source_descriptor, NULL, destination_descriptor, NULL, size - copied, 0);
+        if (result <= 0)
+        {
+            break;
+        }
+        copied += result;
+    }
+    while (copied < size)
+    {
+        ssize_t result = sendfile(destination_descriptor, source_descriptor, NULL, size - copied);
+        if (result <= 0)
+        {
+            break;
+        }
+        copied += result;
+    }
+
+    char buffer[4096];
+    ssize_t bytes_read;
+    while (copied < size && (bytes_read = read(source_descriptor, buffer, sizeof(buffer))) > 0)
+    {
+        if (write(destination_descriptor, buffer, bytes_read) != bytes_read)
+        {
+            perror("write");
+            return 1;
+        }
+        copied += bytes_read;
+    }
+    return copied == size ? 0 : 1;
+}
+
+/* Stage source next to destination, then rename it into place. */
+static int copy_file_atomically(const char *source_path, const char *destination, mode_t mode, off_t size)
+{
+    char temp_path[STRING_LENGTH + 8];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", destination);
+
+    int source_descriptor = open(source_path, O_RDONLY);
+    if (source_descriptor < 0)
+    {
+        perror("open");
+        printf("Failed to open %s for reading\n", source_path);
+        return 1;
+    }
+    int destination_descriptor = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (destination_descriptor < 0)
+    {
+        perror("open");
+        printf("Failed to open %s for writing\n", temp_path);
+        close(source_descriptor);
+        return 1;
+    }
+
+    int result = copy_file_contents(source_descriptor, destination_descriptor, size);
+    close(source_descriptor);
+    if (result != 0 || fchmod(destination_descriptor, mode) != 0 || fsync(destination_descriptor) != 0)
+    {
+        perror("copy");
+        close(destination_descriptor);
+        unlink(temp_path);
+        return 1;
+    }
+    close(destination_descriptor);
+
+    if (rename(temp_path, destination) != 0)
+    {
+        perror("rename");
+        unlink(temp_path);
+        return 1;
+    }
+    sync_parent_directory(destination);
+    return 0;
+}
+
+static int install_copy(const InstallEntry *entry, InstalledManifest *manifest)
+{
+    const char *source_path = entry->source != NULL ? entry->source : settings_file_path;
+    struct stat source_status;
+    if (stat(source_path, &source_status) != 0)
+    {
+        perror("stat");
+        printf("Missing install source %s\n", source_path);
+        return 1;
+    }
+
+    /* Unchanged source and an intact destination, the common case on exit. */
+    InstalledFileRecord *record = find_installed_record(manifest, entry->destination);
+    struct stat destination_status;
+    bool is_destination_intact = stat(entry->destination, &destination_status) == 0 && destination_status.st_size == source_status.st_size;
+    if (record != NULL && is_destination_intact && record->size == source_status.st_size &&
+        record->modified_seconds == source_status.st_mtim.tv_sec && record->modified_nanoseconds == source_status.st_mtim.tv_nsec)
+    {
+        return 0;
+    }
+
+    uint64_t source_hash;
+    if (hash_file(source_path, &source_hash) != 0)
+    {
+        return 1;
+    }
+    bool is_content_current = record != NULL && is_destination_intact && record->content_hash == source_hash;
+    if (!is_content_current)
+    {
+        create_parent_directory(entry->destination);
+        if (copy_file_atomically(source_path, entry->destination, entry->mode, source_status.st_size) != 0)
+        {
+            return 1;
+        }
+        printf("Installed %s\n", entry->destination);
+    }
+
+    if (record == NULL)
+    {
+        if (manifest->count >= INSTALL_MANIFEST_CAPACITY)
+        {
+            return 0;
+        }
+        record = &manifest->records[manifest->count++];
+        snprintf(record->destination, sizeof(record->destination), "%s", entry->destination);
+    }
+    record->size = source_status.st_size;
+    record->modified_seconds = source_status.st_mtim.tv_sec;
+    record->modified_nanoseconds = source_status.st_mtim.tv_nsec;
+    record->content_hash = source_hash;
+    manifest->changed = true;
+    return 0;
+}
+
+static int install_symlink(const InstallEntry *entry)
+{
+    char current_target[STRING_LENGTH];
+    ssize_t target_length = readlink(entry->destination, current_target, sizeof(current_target) - 1);
+    if (target_length >= 0)
+    {
+        current_target[target_length] = '\0';
+        if (strcmp(current_target, entry->source) == 0)
+        {
+            return 0;
+        }
+    }
+
+    /* Keep the stock file the first time it is replaced. */
+    struct stat destination_status;
+    if (entry->backup != NULL && lstat(entry->destination, &destination_status) == 0 && S_ISREG(destination_status.st_mode) &&
+        access(entry->backup, F_OK) != 0 && rename(entry->destination, entry->backup) != 0)
+    {
+        perror("rename");
+        return 1;
+    }
+
+    char temp_path[STRING_LENGTH + 8];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", entry->destination);
+    create_parent_directory(entry->destination);
+    unlink(temp_path);
+    if (symlink(entry->source, temp_path) != 0 || rename(temp_path, entry->destination) != 0)
+    {
+        perror("symlink");
+        unlink(temp_path);
+        return 1;
+    }
+    printf("Linked %s -> %s\n", entry->destination, entry->source);
+    return 0;
+}
+
+static int remove_entry(const InstallEntry *entry, InstalledManifest *manifest)
+{
+    int result = 0;
+    struct stat destination_status;
+    bool exists = lstat(entry->destination, &destination_status) == 0;
+    if (entry->action == INSTALL_COPY)
+    {
+        forget_installed_record(manifest, entry->destination);
+        if (exists && unlink(entry->destination) != 0)
+        {
+            perror("unlink");
+            result = 1;
+        }
+        return result;
+    }
+
+    /* Only remove links we made, never a file someone else put there. */
+    if (exists && S_ISLNK(destination_status.st_mode) && unlink(entry->destination) != 0)
+    {
+        perror("unlink");
+        result = 1;
+    }
+    if (entry->backup != NULL && access(entry->backup, F_OK) == 0 && rename(entry->backup, entry->destination) != 0)
+    {
+        perror("rename");
+        result = 1;
+    }
+    return result;
+}
+
+int install_daemon(bool should_enable_low_battery_indication)
+{
+    trace_begin("install_daemon");
+    if (mkdir(INSTALL_SERVICE_DIRECTORY, 0755) != 0 && errno != EEXIST)
+    {
+        perror("mkdir");
+        trace_end("install_daemon");
+        return 1;
+    }
+
+    InstalledManifest manifest;
+    load_installed_manifest(&manifest);
+    int result = 0;
+    for (size_t entry_index = 0; entry_index < INSTALL_MANIFEST_LENGTH; entry_index++)
+    {
+        const InstallEntry *entry = &install_manifest[entry_index];
+        if (entry->condition == INSTALL_IF_LOW_BATTERY_INDICATION && !should_enable_low_battery_indication)
+        {
+            result |= remove_entry(entry, &manifest);
+        }
+        else if (entry->action == INSTALL_COPY)
+        {
+            result |= install_copy(entry, &manifest);
+        }
+        else
+        {
+            result |= install_symlink(entry);
+        }
+    }
+
+    if (manifest.changed)
+    {
+        result |= save_installed_manifest(&manifest);
+    }
+    trace_end("install_daemon");
+    return result;
+}
+
+int uninstall_daemon(void)
+{
+    printf("Removing all led_controller files from system ...\n");
+    InstalledManifest manifest;
+    load_installed_manifest(&manifest);
+    int result = 0;
+    for (size_t entry_index = INSTALL_MANIFEST_LENGTH; entry_index > 0; entry_index--)
+    {
+        result |= remove_entry(&install_manifest[entry_index - 1], &manifest);
+    }
+
+    /* What's left in the service directory is ours too, i.e the daemon's log
+     * and the shell daemon older versions installed. */
+    unlink(INSTALLED_MANIFEST_FILE);
+    unlink(INSTALL_SERVICE_DIRECTORY "/settings_daemon.log");
+    unlink(INSTALL_SERVICE_DIRECTORY "/settings-daemon.sh");
+    if (rmdir(INSTALL_SERVICE_DIRECTORY) != 0 && errno != ENOENT)
+    {
+        perror("rmdir");
+        result = 1;
+    }
+
+    /* Give other applications their LED access back. */
+    set_led_sys_files_writable(true);
+    return result;
+}
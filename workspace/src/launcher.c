@@ -0,0 +1,129 @@
+#include "launcher.h"
+#include "led_core.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Launch log, NULL until launcher_start opens it. */
+static FILE *launcher_log_file = NULL;
+static char launcher_log_buffer[LAUNCHER_LOG_BUFFER_SIZE];
+
+/* "[YYYY-MM-DD HH:MM:SS]" for the second it was last formatted in. */
+static time_t launcher_timestamp_second = -1;
+static char launcher_timestamp[32];
+
+void launcher_log(const char *format, ...)
+{
+    FILE *output = launcher_log_file != NULL ? launcher_log_file : stdout;
+    time_t now = time(NULL);
+    if (now != launcher_timestamp_second)
+    {
+        struct tm local_time;
+        localtime_r(&now, &local_time);
+        strftime(launcher_timestamp, sizeof(launcher_timestamp), "[%Y-%m-%d %H:%M:%S]", &local_time);
+        launcher_timestamp_second = now;
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    fprintf(output, "%s[led_controller]: ", launcher_timestamp);
+    vfprintf(output, format, arguments);
+    fputc('\n', output);
+    va_end(arguments);
+}
+
+int launcher_start(const char *program_path)
+{
+    /* Same as cd $(dirname "$0"), assets and settings are loaded relative to the pak. */
+    const char *last_slash = strrchr(program_path, '/');
+    if (last_slash != NULL)
+    {
+        char directory[STRING_LENGTH * 2];
+        snprintf(directory, sizeof(directory), "%.*s", (int)(last_slash - program_path), program_path);
+        if (directory[0] != '\0' && chdir(directory) != 0)
+        {
+            perror("chdir");
+        }
+    }
+
+    launcher_log_file = fopen(LAUNCHER_LOG_FILE, "a");
+    if (!launcher_log_file)
+    {
+        perror("fopen");
+        printf("Failed to open %s, logging to stdout\n", LAUNCHER_LOG_FILE);
+    }
+    else
+    {
+        setvbuf(launcher_log_file, launcher_log_buffer, _IOFBF, sizeof(launcher_log_buffer));
+        /* launch.sh ran the app with 2>>$LOG_FILE, SDL_Log and perror end up there. */
+        fflush(stderr);
+        dup2(fileno(launcher_log_file), STDERR_FILENO);
+    }
+
+    launcher_log("Launching %s", program_path);
+    launcher_log("Enabling write permissions on %s files", led_sys_file_path);
+    int result = set_led_sys_files_writable(true);
+    return (launcher_log_file != NULL && result == 0) ? 0 : 1;
+}
+
+uint32_t launcher_millis_since_exec(void)
+{
+    FILE *file = fopen("/proc/self/stat", "r");
+    if (!file)
+    {
+        return 0;
+    }
+    char stat_text[1024];
+    size_t length = fread(stat_text, 1, sizeof(stat_text) - 1, file);
+    fclose(file);
+    stat_text[length] = '\0';
+
+    /* The command name may contain spaces, fields are counted from its closing parenthesis. */
+    char *cursor = strrchr(stat_text, ')');
+    if (cursor == NULL)
+    {
+        return 0;
+    }
+    /* The parenthesis closes field 2, stop on the space before starttime (field 22). */
+    for (int field = 3; field <= 22 && cursor != NULL; field++)
+    {
+        cursor = strchr(cursor + 1, ' ');
+    }
+    if (cursor == NULL)
+    {
+        return 0;
+    }
+    unsigned long long start_ticks = strtoull(cursor + 1, NULL, 10);
+
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    uint64_t now_millis = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    uint64_t start_millis = start_ticks * 1000 / (uint64_t)sysconf(_SC_CLK_TCK);
+    return now_millis > start_millis ? (uint32_t)(now_millis - start_millis) : 0;
+}
+
+int launcher_finish(int exit_code)
+{
+    launcher_log("led_controller returned: %d", exit_code);
+
+    if (exit_code == UNINSTALL_EXIT_CODE)
+    {
+        launcher_log("Turning off all LEDs");
+        write_all_leds_power(false);
+    }
+
+    /* Prevent other applications from changing the LEDs. */
+    launcher_log("Disabling write permissions on %s files", led_sys_file_path);
+    set_led_sys_files_writable(false);
+    launcher_log("exiting...");
+
+    if (launcher_log_file != NULL)
+    {
+        fclose(launcher_log_file);
+        launcher_log_file = NULL;
+    }
+    return 0;
+}
@@ -3,307 +3,525 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <dirent.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
-int main(int argc, char *argv[])
-{
-    /* Handle program inputs */
-    bool verbose_logging_enabled = argc > 1 && strcmp(argv[1], "-v") == 0;
-
-    /* Core SDL components that every application (I write) requires. */
-    CoreSDLComponents core_components;
-
-    /* SDL components that this application (I write) requires beyond the core components. */
-    AdditionalSDLComponents components;
-
-    /* User state object, contains all relevant user selection information. */
-    AppState app_state;
-
-    /* The collection of user interface related objects. */
-    SelectableMenuItems config_page_ui;
-
-    /* The collection of user interface related objects. */
-    SelectableMenuItems menu_page_ui;
+/* Eggshell white color for main text */
+SDL_Color text_color = {255, 239, 186, 255};
 
-    Sprite brick_sprite;
-    /* The last user input converted from SDL_Event. */
-    InputType user_input;
+/* Semi-transparent black for shadow */
+SDL_Color text_shadow_color = {0, 0, 0, 128};
 
-    /* SDL event object we read on loop. */
-    SDL_Event event;
-
-    /* Initialize onscreen logging message */
-
-    /* Initialize Primary SDL components */
-    core_components.window_width = WINDOW_WIDTH;
-    core_components.window_height = WINDOW_HEIGHT;
+int parse_program_options(int argc, char *argv[], ProgramOptions *options)
+{
+    options->verbose_logging_enabled = false;
+    options->trace_output_path = NULL;
+    options->headless = false;
+    options->headless_frame_count = HEADLESS_DEFAULT_FRAME_COUNT;
+    options->input_script_path = NULL;
+    options->frame_dump_directory = NULL;
+    options->record_path = NULL;
+    options->replay_path = NULL;
+    options->replay_at_max_speed = false;
+    options->sys_file_root = NULL;
+    options->launch = false;
+    options->full_color_textures = false;
+    options->renderer_name = NULL;
+    options->repeat_delay_millis = BUTTON_REPEAT_DELAY_MILLIS;
+    options->repeat_acceleration_percent = BUTTON_REPEAT_ACCELERATION_PERCENT;
+    options->soak_input_count = 0;
+    options->verify_steady_sdl_heap = false;
+
+    int unknown_argument_count = 0;
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        const char *argument = argv[arg_index];
+        if (strcmp(argument, "-v") == 0)
+        {
+            options->verbose_logging_enabled = true;
+        }
+        else if (strncmp(argument, "--trace=", strlen("--trace=")) == 0)
+        {
+            options->trace_output_path = argument + strlen("--trace=");
+        }
+        else if (strcmp(argument, "--headless") == 0)
+        {
+            options->headless = true;
+        }
+        else if (strncmp(argument, "--frames=", strlen("--frames=")) == 0)
+        {
+            options->headless_frame_count = clamp(atoi(argument + strlen("--frames=")), 1, INT32_MAX);
+        }
+        else if (strncmp(argument, "--input-script=", strlen("--input-script=")) == 0)
+        {
+            options->input_script_path = argument + strlen("--input-script=");
+        }
+        else if (strncmp(argument, "--dump-frames=", strlen("--dump-frames=")) == 0)
+        {
+            options->frame_dump_directory = argument + strlen("--dump-frames=");
+        }
+        else if (strncmp(argument, "--record=", strlen("--record=")) == 0)
+        {
+            options->record_path = argument + strlen("--record=");
+        }
+        else if (strncmp(argument, "--replay=", strlen("--replay=")) == 0)
+        {
+            options->replay_path = argument + strlen("--replay=");
+        }
+        else if (strcmp(argument, "--replay-speed=max") == 0)
+        {
+            options->replay_at_max_speed = true;
+        }
+        else if (strcmp(argument, "--replay-speed=original") == 0)
+        {
+            options->replay_at_max_speed = false;
+        }
+        else if (strncmp(argument, "--sys-root=", strlen("--sys-root=")) == 0)
+        {
+            options->sys_file_root = argument + strlen("--sys-root=");
+        }
+        else if (strcmp(argument, "--launch") == 0)
+        {
+            options->launch = true;
+        }
+        else if (strcmp(argument, "--full-color-textures") == 0)
+        {
+            options->full_color_textures = true;
+        }
+        else if (strncmp(argument, "--renderer=", strlen("--renderer=")) == 0)
+        {
+            options->renderer_name = argument + strlen("--renderer=");
+        }
+        else if (strncmp(argument, "--soak=", strlen("--soak=")) == 0)
+        {
+            options->soak_input_count = clamp(atoi(argument + strlen("--soak=")), 1, REPLAY_INPUT_CAPACITY);
+            options->headless = true;
+        }
+        else if (strcmp(argument, "--verify-steady-sdl-heap") == 0)
+        {
+            options->verify_steady_sdl_heap = true;
+            options->headless = true;
+        }
+        else if (strncmp(argument, "--repeat-delay=", strlen("--repeat-delay=")) == 0)
+        {
+            options->repeat_delay_millis = clamp(atoi(argument + strlen("--repeat-delay=")), 0, 5000);
+        }
+        else if (strncmp(argument, "--repeat-acceleration=", strlen("--repeat-acceleration=")) == 0)
+        {
+            options->repeat_acceleration_percent = clamp(atoi(argument + strlen("--repeat-acceleration=")), 0, 100);
+        }
+        else
+        {
+            SDL_Log("Ignoring unknown argument: %s", argument);
+            unknown_argument_count++;
+        }
+    }
+    return unknown_argument_count == 0 ? 0 : 1;
+}
 
-    /* Initialize auxilliary data structures */
-    initialize_app_state(&app_state);
-    update_leds(&app_state);
-    if (initialize_sdl_core(&core_components, WINDOW_TITLE) != 0 ||
-        initialize_additional_sdl_components(&core_components, &components) != 0)
+int load_input_script(const char *script_path, RecordedInput *inputs, int capacity)
+{
+    FILE *file = fopen(script_path, "r");
+    if (!file)
     {
-        SDL_Log("Failed to initialize SDL, exiting...\n");
-        return 1;
+        perror("fopen");
+        SDL_Log("Failed to open input script %s", script_path);
+        return -1;
     }
-    initialize_config_page_ui(&config_page_ui, &core_components, &components);
-    initialize_menu_ui(&menu_page_ui, &core_components, &components, &app_state);
-
-    update_config_page_ui_text(&config_page_ui, &core_components, &components, &app_state);
-    update_menu_ui_text(&menu_page_ui, &core_components, &components, &app_state);
 
-    /* Initialize sprites */
-    initialize_brick_sprite(&brick_sprite, core_components.renderer);
-    /* Render the background */
-    SDL_RenderCopy(core_components.renderer, components.backgroundTexture, NULL, NULL);
-    while (!app_state.should_quit)
-    {
-        /* Handle events */
-        while (SDL_PollEvent(&event) != 0)
+    char line[STRING_LENGTH];
+    int input_count = 0;
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) && input_count < capacity)
+    {
+        line_number++;
+        int frame;
+        char input_name[STRING_LENGTH];
+        /* Skip blank lines and comments */
+        if (line[0] == '#' || sscanf(line, "%d %255s", &frame, input_name) != 2)
         {
-            /* Ignore unsupported input events */
-            if (!is_supported_input_event(event.type))
-            {
-                continue;
-            }
-
-            if (event.type == SDL_QUIT)
-            {
-                app_state.should_quit = true;
-                break;
-            }
-            /* Take and process user input. */
-            user_input = sdl_event_to_input_type(&event, false);
-
-            handle_event_updates(&app_state, &core_components, &components, &config_page_ui, &menu_page_ui, user_input, event);
+            continue;
         }
 
-        /* Call the render_frame function */
-        render_frame(&app_state, &core_components, &components, &brick_sprite, &config_page_ui, &menu_page_ui, verbose_logging_enabled);
+        InputType input = input_type_from_name(input_name);
+        if (input == UNKNOWN || frame < 0)
+        {
+            SDL_Log("Ignoring invalid input script line %d: %s", line_number, line);
+            continue;
+        }
+        /* Scripts are frame based, place each input on the replay clock at that frame. */
+        inputs[input_count++] = (RecordedInput){(Uint32)frame * REPLAY_FRAME_MILLIS, input};
     }
+    fclose(file);
+    return input_count;
+}
 
-    save_settings(&app_state);
-    update_leds(&app_state);
-    if (app_state.should_install_daemon)
-    {
-        install_daemon();
-    }
-    return teardown(&core_components, &components, &config_page_ui, &menu_page_ui, &brick_sprite, &app_state);
+int generate_soak_inputs(RecordedInput *inputs, int capacity, int input_count)
+{
+    /* Config page inputs only, Quit or Uninstall on the menu page would end the run early. */
+    static const InputType soak_inputs[] = {DPAD_UP, DPAD_DOWN, DPAD_LEFT, DPAD_RIGHT, DPAD_RIGHT, L1, R1, A};
+    const int soak_input_kinds = sizeof(soak_inputs) / sizeof(soak_inputs[0]);
+    uint32_t random_state = 0x2545F491u;
+    input_count = input_count < capacity ? input_count : capacity;
+    for (int input_index = 0; input_index < input_count; input_index++)
+    {
+        /* Fixed seed xorshift, every soak run sees the same inputs. */
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        inputs[input_index] = (RecordedInput){(Uint32)input_index * REPLAY_FRAME_MILLIS, soak_inputs[random_state % soak_input_kinds]};
+    }
+    return input_count;
 }
 
-void handle_user_input(InputType user_input, AppState *app_state, SDL_GameController *controller)
+static char scratch_sys_root[] = SCRATCH_SYS_ROOT_TEMPLATE;
+
+/* Registered with atexit, so every exit path of a replay cleans up after itself. */
+static void remove_scratch_sys_root(void)
 {
-    switch (app_state->current_page)
-    {
-    case CONFIG_PAGE:
+    DIR *directory = opendir(scratch_sys_root);
+    if (directory != NULL)
     {
-        switch (user_input)
+        struct dirent *entry;
+        char filepath[STRING_LENGTH];
+        while ((entry = readdir(directory)) != NULL)
         {
-        case POWER:
-            /* power button safely exits app */
-            app_state->should_quit = true;
-            break;
-        case START:
-        case SELECT:
-            app_state->current_page = MENU_PAGE;
-            break;
-            break;
-        case A:
-            handle_change_setting(app_state, 0);
-            app_state->should_update_leds = true;
-            break;
-        case B:
-            switch (app_state->current_page)
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
             {
-            case MENU_PAGE:
-                /* close menu */
-                app_state->current_page = CONFIG_PAGE;
-                break;
-            case CONFIG_PAGE:
-                /* exit app */
-                app_state->should_quit = true;
-                break;
+                snprintf(filepath, sizeof(filepath), "%s/%s", scratch_sys_root, entry->d_name);
+                unlink(filepath);
             }
-            break;
-        case DPAD_UP:
-            /* Switch between settings */
-            app_state->selected_setting = (app_state->selected_setting - 1 + LED_SETTINGS_COUNT) % LED_SETTINGS_COUNT;
-            break;
-        case DPAD_DOWN:
-            /* Switch between settings */
-            app_state->selected_setting = (app_state->selected_setting + 1 + LED_SETTINGS_COUNT) % LED_SETTINGS_COUNT;
-            break;
-        case DPAD_RIGHT:
-            handle_change_setting(app_state, 1);
-            app_state->should_update_leds = true;
-            break;
-        case DPAD_LEFT:
-            handle_change_setting(app_state, -1);
-            app_state->should_update_leds = true;
-            break;
-        case L1:
-        case L2:
-        case L3:
-            app_state->selected_led = (app_state->selected_led - 1 + LED_COUNT) % LED_COUNT;
-            break;
-        case R1:
-        case R2:
-        case R3:
-            app_state->selected_led = (app_state->selected_led + 1) % LED_COUNT;
-            break;
-        default:
-            break;
-        }
-    }
-    break;
-    case MENU_PAGE:
-    {
-        switch (user_input)
-        {
-        case START:
-        case SELECT:
-        case B:
-            app_state->current_page = CONFIG_PAGE;
-            break;
-        case A:
-            handle_menu_select(app_state, app_state->selected_menu_option);
-            break;
-        case DPAD_UP:
-            /* Switch between settings */
-            app_state->selected_menu_option = (app_state->selected_menu_option - 1 + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
-            break;
-        case DPAD_DOWN:
-            /* Switch between settings */
-            app_state->selected_menu_option = (app_state->selected_menu_option + 1 + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
-            break;
-        default:
-            break;
-        }
-    }
-    break;
+        }
+        closedir(directory);
     }
+    rmdir(scratch_sys_root);
 }
-void handle_change_setting(AppState *app_state, int change)
+
+int use_scratch_sys_root(void)
 {
-    LedSettings *selected_led_settings = &app_state->led_settings[app_state->selected_led];
-    switch (app_state->selected_setting)
+    if (mkdtemp(scratch_sys_root) == NULL)
     {
-    case SELECTED_LED:
+        perror("mkdtemp");
+        return 1;
+    }
+    atexit(remove_scratch_sys_root);
+    led_sys_file_path = scratch_sys_root;
+    return 0;
+}
+
+/* Compare the resource counts at the end of a soak run with the ones taken after warming up. */
+static int check_soak_counts(const ResourceCounts *warm_counts, int measured_frames)
+{
+    ResourceCounts end_counts;
+    get_resource_counts(&end_counts);
+    printf("Soak resources after warmup -> end:\n");
+    printf("  textures:          %d -> %d (%llu -> %llu KiB)\n", warm_counts->live_textures, end_counts.live_textures,
+           (unsigned long long)warm_counts->live_texture_bytes / 1024, (unsigned long long)end_counts.live_texture_bytes / 1024);
+    printf("  surfaces:          %d -> %d\n", warm_counts->live_surfaces, end_counts.live_surfaces);
+    printf("  SDL_malloc:        %d -> %d live, %.1f calls per frame\n", warm_counts->live_allocation_count, end_counts.live_allocation_count,
+           measured_frames > 0 ? (double)(end_counts.allocation_count - warm_counts->allocation_count) / measured_frames : 0.0);
+    printf("  (libc malloc from FreeType, libpng and the app isn't counted)\n");
+    log_live_resources();
+
+    int result = 0;
+    if (end_counts.live_textures != warm_counts->live_textures || end_counts.live_surfaces != warm_counts->live_surfaces)
     {
-        app_state->selected_led = (app_state->selected_led - change + LED_COUNT) % LED_COUNT;
-        break;
+        printf("Soak failed: textures or surfaces leaked\n");
+        result = 1;
     }
-    case BRIGHTNESS:
+    if (end_counts.live_allocation_count > warm_counts->live_allocation_count + SOAK_ALLOCATION_SLACK)
     {
-        /* Bounds checking because looping around from max brightness to 0 brightness feels bad. */
-        selected_led_settings->brightness = clamp(selected_led_settings->brightness + (change * BRIGHTNESS_INCREMENT), 0, MAX_BRIGHTNESS);
-        break;
+        printf("Soak failed: %d SDL_malloc allocations were never freed\n", end_counts.live_allocation_count - warm_counts->live_allocation_count);
+        result = 1;
     }
-    case EFFECT:
-        selected_led_settings->effect = clamp(selected_led_settings->effect + change, 0, ANIMATION_EFFECT_COUNT - 1);
-        break;
-    case DURATION:
-        selected_led_settings->duration = clamp(selected_led_settings->duration + DURATION_INCREMENT * change, 0, MAX_DURATION);
-        break;
-    case COLOR:
+    return result;
+}
+
+/* SDL_malloc calls made after the first frame of a run without input, the steady state should make none.
+ * libc malloc calls (FreeType, libpng and the app itself) don't go through SDL and aren't seen here. */
+static int check_steady_sdl_heap(const ResourceCounts *first_frame_counts, int measured_frames)
+{
+    ResourceCounts end_counts;
+    get_resource_counts(&end_counts);
+    Uint32 allocation_count = end_counts.allocation_count - first_frame_counts->allocation_count;
+    printf("Steady state: %u SDL_malloc calls in %d frames after the first, %d -> %d live SDL allocations (libc malloc not counted)\n",
+           allocation_count, measured_frames, first_frame_counts->live_allocation_count, end_counts.live_allocation_count);
+    if (allocation_count != 0 || end_counts.live_textures != first_frame_counts->live_textures ||
+        end_counts.live_surfaces != first_frame_counts->live_surfaces)
+    {
+        printf("Steady state check failed: frames after the first called SDL_malloc or changed the live textures or surfaces\n");
+        log_live_resources();
+        return 1;
+    }
+    return 0;
+}
+
+void handle_replayed_inputs(InputPlayback *playback, Uint32 clock_millis, AppState *app_state, CoreSDLComponents *core_components,
+                            AdditionalSDLComponents *components, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui)
+{
+    InputType replayed_input;
+    SDL_Event event;
+    /* Replayed inputs have no SDL event, use a supported type so they take the same path as real input. */
+    event.type = SDL_CONTROLLERBUTTONDOWN;
+
+    while (next_due_input(playback, clock_millis, &replayed_input))
     {
-        if (app_state->are_extended_colors_enabled)
+        if (replayed_input == UNKNOWN)
         {
-            selected_led_settings->color = next_color(selected_led_settings->color, change);
+            /* End of the recorded session */
+            app_state->should_quit = true;
+            return;
         }
-        else
-        {
-            /* Find the current color index in colors */
-            int current_color_index = -1;
-            for (int i = 0; i < num_color; i++)
-            {
-                if (colors[i] == selected_led_settings->color)
-                {
-                    current_color_index = i;
-                    break;
-                }
-            }
+        handle_event_updates(app_state, core_components, components, config_page_ui, menu_page_ui, replayed_input, event);
+    }
+}
 
-            /* If the current color is not found, default to the first color */
-            if (current_color_index == -1)
-            {
-                current_color_index = 0;
-            }
+void log_session_counters(int frames_rendered, Uint64 render_ticks_total, Uint64 render_ticks_max)
+{
+    double ticks_per_millisecond = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    printf("Session counters:\n");
+    printf("  frames rendered:   %d\n", frames_rendered);
+    printf("  LED file writes:   %lu\n", led_sys_file_write_count);
+    printf("  textures created:  %llu\n", (unsigned long long)get_textures_created_count());
+    printf("  draw calls:        %llu (%.1f per frame)\n", (unsigned long long)get_draw_call_count(),
+           frames_rendered > 0 ? (double)get_draw_call_count() / frames_rendered : 0.0);
+    ResourceCounts resource_counts;
+    get_resource_counts(&resource_counts);
+    printf("  live textures:     %d (%llu KiB), %d SDL allocations\n", resource_counts.live_textures,
+           (unsigned long long)resource_counts.live_texture_bytes / 1024, resource_counts.live_allocation_count);
+    printf("  events dropped:    %u (deepest queue %d)\n", get_events_dropped_count(), get_max_event_queue_depth());
+    printf("  frame time:        %.3f ms avg, %.3f ms max\n",
+           frames_rendered > 0 ? render_ticks_total / ticks_per_millisecond / frames_rendered : 0.0,
+           render_ticks_max / ticks_per_millisecond);
+}
 
-            /* Update the color index based on the change */
-            current_color_index = (current_color_index + change + num_color) % num_color;
+int run_headless_session(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite,
+                         SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, InputPlayback *playback,
+                         const ProgramOptions *options)
+{
+    int frame_count = options->headless_frame_count;
 
-            /* Set the new color */
-            selected_led_settings->color = colors[current_color_index];
+    /* Always run long enough to play back every input. */
+    if (playback->input_count > 0)
+    {
+        int last_input_frame = playback->inputs[playback->input_count - 1].timestamp_millis / REPLAY_FRAME_MILLIS;
+        if (last_input_frame >= frame_count)
+        {
+            frame_count = last_input_frame + 1;
         }
     }
-    break;
-    case MATCH_SETTINGS:
-        /* Change was from the user selecting the A button*/
-        if (change == 0)
+
+    Uint64 stage_ticks[HEADLESS_STAGE_COUNT] = {0};
+    const char *stage_names[HEADLESS_STAGE_COUNT] = {"input", "render", "capture"};
+    Uint64 ticks_per_second = SDL_GetPerformanceFrequency();
+    Uint64 session_start = SDL_GetPerformanceCounter();
+    Uint64 render_ticks_max = 0;
+    int frames_rendered = 0;
+    SDL_Event event;
+    char frame_path[STRING_LENGTH];
+    /* Soak runs take their baseline once caches are warm, the rest of the run must not grow it. */
+    int soak_warmup_frame = options->soak_input_count * SOAK_WARMUP_PERCENT / 100;
+    ResourceCounts warm_counts = {0};
+    ResourceCounts first_frame_counts = {0};
+
+    for (int frame = 0; frame < frame_count && !app_state->should_quit; frame++)
+    {
+        /* Headless runs always replay at maximum speed, the clock advances a fixed step per frame. */
+        Uint64 stage_start = SDL_GetPerformanceCounter();
+        SDL_PumpEvents();
+        note_event_queue_depth();
+        while (SDL_PollEvent(&event) != 0)
         {
-            color_match_leds(app_state);
+            /* Drain the dummy driver's queue so it can't grow over long runs. */
         }
-        break;
-    default:
-        break;
+        handle_replayed_inputs(playback, (Uint32)frame * REPLAY_FRAME_MILLIS, app_state, core_components, components, config_page_ui, menu_page_ui);
+        Uint64 stage_end = SDL_GetPerformanceCounter();
+        stage_ticks[HEADLESS_STAGE_INPUT] += stage_end - stage_start;
+
+        stage_start = stage_end;
+        render_frame(app_state, core_components, components, brick_sprite, config_page_ui, menu_page_ui, (Uint32)frame * REPLAY_FRAME_MILLIS,
+                     options->verbose_logging_enabled);
+        stage_end = SDL_GetPerformanceCounter();
+        stage_ticks[HEADLESS_STAGE_RENDER] += stage_end - stage_start;
+        render_ticks_max = stage_end - stage_start > render_ticks_max ? stage_end - stage_start : render_ticks_max;
+
+        if (options->frame_dump_directory != NULL)
+        {
+            stage_start = stage_end;
+            snprintf(frame_path, sizeof(frame_path), "%s/frame_%05d.png", options->frame_dump_directory, frame);
+            save_frame_to_png(core_components, frame_path);
+            stage_end = SDL_GetPerformanceCounter();
+            stage_ticks[HEADLESS_STAGE_CAPTURE] += stage_end - stage_start;
+        }
+        if (options->soak_input_count > 0 && frame == soak_warmup_frame)
+        {
+            get_resource_counts(&warm_counts);
+        }
+        if (frame == 0)
+        {
+            get_resource_counts(&first_frame_counts);
+        }
+        frames_rendered++;
+    }
+
+    double session_millis = (double)(SDL_GetPerformanceCounter() - session_start) * 1000.0 / ticks_per_second;
+    printf("Headless session: %d frames in %.1f ms (%.1f fps)\n",
+           frames_rendered, session_millis, session_millis > 0 ? frames_rendered * 1000.0 / session_millis : 0.0);
+    for (int stage = 0; stage < HEADLESS_STAGE_COUNT; stage++)
+    {
+        double stage_millis = (double)stage_ticks[stage] * 1000.0 / ticks_per_second;
+        printf("  %-8s %9.1f ms total, %7.3f ms/frame\n",
+               stage_names[stage], stage_millis, frames_rendered > 0 ? stage_millis / frames_rendered : 0.0);
+    }
+    log_session_counters(frames_rendered, stage_ticks[HEADLESS_STAGE_RENDER], render_ticks_max);
+    if (options->verify_steady_sdl_heap)
+    {
+        return check_steady_sdl_heap(&first_frame_counts, frames_rendered - 1);
     }
+    return options->soak_input_count > 0 ? check_soak_counts(&warm_counts, frames_rendered - soak_warmup_frame - 1) : 0;
 }
 
-void handle_menu_select(AppState *app_state, MenuOption selected_menu_option)
-{
-    switch (selected_menu_option)
-    {
-    case ENABLE_ALL:
-        turn_on_all_leds(app_state);
-        break;
-    case DISABLE_ALL:
-        turn_off_all_leds(app_state);
-        break;
-    case TOGGLE_EXTENDED_COLORS:
-        app_state->are_extended_colors_enabled = !app_state->are_extended_colors_enabled;
-        break;
-    case TOGGLE_LOW_BATTERY_INDICATION:
-        app_state->should_enable_low_battery_indication = !app_state->should_enable_low_battery_indication;
-        break;
-    case UNINSTALL:
-        uninstall_daemon();
-        app_state->should_install_daemon = false;
-        app_state->should_quit = true;
-        break;
-    case QUIT:
-        app_state->should_quit = true;
-        break;
-    default:
-        break;
+/* Push whatever the handled inputs changed out to the LEDs and the menu text. */
+static void apply_input_changes(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components,
+                                SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui)
+{
+    if (app_state->should_update_leds)
+    {
+        commit_dirty_leds(app_state);
+    }
+    if (app_state->should_save_settings)
+    {
+        /* Written by save_settings_if_idle once the user stops changing things. */
+        request_settings_save(app_state, SDL_GetTicks());
     }
+    update_config_page_ui_text(config_page_ui, core_components, components, app_state);
+    update_menu_ui_text(menu_page_ui, core_components, components, app_state);
 }
 
 void handle_event_updates(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components,
                           SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui,
                           InputType user_input, SDL_Event event)
 {
-    handle_user_input(user_input, app_state, core_components->controller);
+    trace_begin("handle_event_updates");
+    handle_user_input(user_input, app_state);
 
     if (is_supported_input_event(event.type))
     {
-        if (app_state->should_update_leds)
-        {
-            update_leds(app_state);
-        }
-        if (app_state->should_save_settings)
-        {
-            save_settings(app_state);
-        }
-        update_config_page_ui_text(config_page_ui, core_components, components, app_state);
-        update_menu_ui_text(menu_page_ui, core_components, components, app_state);
+        apply_input_changes(app_state, core_components, components, config_page_ui, menu_page_ui);
+    }
+    trace_end("handle_event_updates");
+}
+
+void handle_repeated_inputs(ButtonRepeat *repeat, Uint32 now_millis, InputRecorder *recorder, AppState *app_state,
+                            CoreSDLComponents *core_components, AdditionalSDLComponents *components,
+                            SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui)
+{
+    InputType repeated_input;
+    bool any_repeated = false;
+    while (next_repeated_input(repeat, now_millis, &repeated_input))
+    {
+        /* Recorded like presses so a replay steps the same way without knowing about repeats. */
+        input_recorder_write(recorder, repeated_input, now_millis);
+        handle_user_input(repeated_input, app_state);
+        any_repeated = true;
+    }
+    if (any_repeated)
+    {
+        trace_begin("handle_repeated_inputs");
+        apply_input_changes(app_state, core_components, components, config_page_ui, menu_page_ui);
+        trace_end("handle_repeated_inputs");
+    }
+}
+
+void handle_analog_stick(AnalogStick *stick, Uint32 now_millis, InputRecorder *recorder, AppState *app_state,
+                         CoreSDLComponents *core_components, AdditionalSDLComponents *components,
+                         SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui)
+{
+    /* Hue and brightness sweep in fine steps, discrete rows and the menu page step like D-pad presses. */
+    int sweep_rate = sweep_steps_per_second(app_state);
+    int steps = analog_stick_steps(stick, now_millis, sweep_rate > 0 ? sweep_rate : ANALOG_STICK_MAX_STEPS_PER_SECOND);
+    if (steps == 0)
+    {
+        return;
+    }
+
+    trace_begin("handle_analog_stick");
+    /* Each step is recorded as its own input, so replays move the setting the same way. */
+    InputType step_input = sweep_rate > 0 ? (steps > 0 ? SWEEP_RIGHT : SWEEP_LEFT) : (steps > 0 ? DPAD_RIGHT : DPAD_LEFT);
+    for (int step = 0; step < abs(steps); step++)
+    {
+        input_recorder_write(recorder, step_input, now_millis);
+        handle_user_input(step_input, app_state);
+    }
+    apply_input_changes(app_state, core_components, components, config_page_ui, menu_page_ui);
+    trace_end("handle_analog_stick");
+}
+/* Files loaded before the first frame. */
+typedef enum
+{
+    ASSET_BACKGROUND_IMAGE,
+    ASSET_MENU_IMAGE,
+    ASSET_BRICK_SPRITE_SHEET,
+    ASSET_FONT,
+    STARTUP_ASSET_COUNT,
+} StartupAsset;
+
+/* One startup asset, decoded to a surface (or opened as a font) on a worker thread. */
+typedef struct
+{
+    const char *path;
+    bool is_font;
+    /* Set when the image is in the asset pack, nothing to decode */
+    const AssetPackEntry *pack_entry;
+    SDL_Surface *surface;
+    /* Measured on the worker, picks the texture format */
+    ImageAlphaType alpha_type;
+    TTF_Font *font;
+    SDL_Thread *thread;
+    Uint64 decode_ticks;
+    /* SDL errors are per thread, copied here for the render thread to report */
+    char error[STRING_LENGTH];
+} StartupAssetLoad;
+
+/* Worker thread body. Only this thread touches FreeType while fonts load, libpng keeps no shared state. */
+static int decode_startup_asset(void *data)
+{
+    StartupAssetLoad *load = (StartupAssetLoad *)data;
+    trace_begin(load->path);
+    Uint64 decode_start = SDL_GetPerformanceCounter();
+
+    /* EMBED_ASSETS=1 builds read from the executable instead of the SD card. */
+    const unsigned char *embedded_data;
+    size_t embedded_size;
+    SDL_RWops *embedded_file = NULL;
+    if (find_embedded_asset(load->path, &embedded_data, &embedded_size))
+    {
+        embedded_file = SDL_RWFromConstMem(embedded_data, (int)embedded_size);
     }
+
+    if (load->is_font)
+    {
+        load->font = embedded_file != NULL ? TTF_OpenFontRW(embedded_file, 1, 32) : TTF_OpenFont(load->path, 32);
+    }
+    else
+    {
+        load->surface = track_surface(embedded_file != NULL ? IMG_Load_RW(embedded_file, 1) : IMG_Load(load->path), __func__);
+        load->alpha_type = load->surface != NULL ? get_surface_alpha_type(load->surface) : IMAGE_ALPHA_BLENDED;
+    }
+    load->decode_ticks = SDL_GetPerformanceCounter() - decode_start;
+    if (load->surface == NULL && load->font == NULL)
+    {
+        snprintf(load->error, sizeof(load->error), "%s", SDL_GetError());
+    }
+    trace_end(load->path);
+    return 0;
 }
+
 int initialize_additional_sdl_components(CoreSDLComponents *core_components, AdditionalSDLComponents *components)
 {
     /* Initialize SDL_image */
@@ -323,48 +541,111 @@ int initialize_additional_sdl_components(CoreSDLComponents *core_components, Add
         return 1;
     }
 
-    /* Create a texture to render from the background image. */
-    components->backgroundTexture = create_sdl_texture_from_image(core_components->renderer, BACKGROUND_IMAGE_PATH);
+    /* The only heap allocation behind the menus and the sprite, sized for every one of them up front. */
+    if (initialize_ui_arena(&components->ui_arena, UI_ARENA_SIZE) != 0)
+    {
+        return 1;
+    }
 
-    components->menuTexture = create_sdl_texture_from_image(core_components->renderer, MENU_IMAGE_PATH);
+    /* Decode every image and open the font on worker threads, only the uploads need the renderer. */
+    StartupAssetLoad loads[STARTUP_ASSET_COUNT] = {
+        [ASSET_BACKGROUND_IMAGE] = {.path = BACKGROUND_IMAGE_PATH},
+        [ASSET_MENU_IMAGE] = {.path = MENU_IMAGE_PATH},
+        [ASSET_BRICK_SPRITE_SHEET] = {.path = BRICK_SPRITE_SHEET_PATH},
+        [ASSET_FONT] = {.path = FONT_PATH, .is_font = true},
+    };
+    double ticks_per_millisecond = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    Uint64 load_start = SDL_GetPerformanceCounter();
 
-    if (!components->backgroundTexture || !components->menuTexture)
+    /* The deduplicated atlas replaces the full strip whenever its index is next to it. */
+    components->brickSpriteAtlas = (SpriteAtlas){0};
+    if (!are_assets_embedded() && load_sprite_atlas(&components->brickSpriteAtlas, BRICK_SPRITE_ATLAS_INDEX_PATH) == 0)
     {
-
-        return 1;
+        loads[ASSET_BRICK_SPRITE_SHEET].path = BRICK_SPRITE_ATLAS_PATH;
     }
 
-    /* Load font */
-    components->font = TTF_OpenFont("assets/retro_gaming.ttf", 32); /* Specify your font path */
-    if (!components->font)
+    /* Predecoded images skip IMG_Load entirely, anything missing from the pack falls back to its PNG.
+     * Embedded builds never touch the filesystem for assets, so they don't look for a pack. */
+    AssetPack asset_pack = {0};
+    if (!are_assets_embedded() && open_asset_pack(&asset_pack, ASSET_PACK_PATH) != 0)
     {
-        SDL_Log("Failed to load font! TTF_Error: %s\n", TTF_GetError());
-        return 1;
+        printf("No asset pack at %s, decoding PNGs\n", ASSET_PACK_PATH);
+    }
+    for (int asset = 0; asset < STARTUP_ASSET_COUNT; asset++)
+    {
+        loads[asset].pack_entry = loads[asset].is_font ? NULL : find_asset_pack_entry(&asset_pack, loads[asset].path);
+        if (loads[asset].pack_entry != NULL)
+        {
+            continue;
+        }
+        loads[asset].thread = SDL_CreateThread(decode_startup_asset, "asset_loader", &loads[asset]);
+        if (loads[asset].thread == NULL)
+        {
+            decode_startup_asset(&loads[asset]);
+        }
     }
 
-    return 0;
-}
+    /* Upload each image as soon as its worker finishes, while the rest keep decoding. */
+    SDL_Texture **textures[STARTUP_ASSET_COUNT] = {
+        [ASSET_BACKGROUND_IMAGE] = &components->backgroundTexture,
+        [ASSET_MENU_IMAGE] = &components->menuTexture,
+        [ASSET_BRICK_SPRITE_SHEET] = &components->brickSpriteSheetTexture,
+    };
+    int result = 0;
+    size_t texture_byte_count = 0;
+    for (int asset = 0; asset < STARTUP_ASSET_COUNT; asset++)
+    {
+        StartupAssetLoad *load = &loads[asset];
+        if (load->thread != NULL)
+        {
+            SDL_WaitThread(load->thread, NULL);
+        }
 
-int initialize_app_state(AppState *app_state)
-{
-    /* Begin with first LED selected. */
-    app_state->selected_led = LED_FRONT;
-    app_state->selected_setting = BRIGHTNESS;
-    app_state->should_save_settings = false;
-    app_state->should_quit = false;
-    app_state->should_install_daemon = true;
-    app_state->are_extended_colors_enabled = false;
-    app_state->should_enable_low_battery_indication = true;
-    app_state->current_page = CONFIG_PAGE;
-    app_state->selected_menu_option = ENABLE_ALL;
+        /* 16 bit formats halve the texture memory when the image's alpha allows it. Pack images
+         * keep the pack's own format, converting them here would redo work on every launch. */
+        Uint64 upload_start = SDL_GetPerformanceCounter();
+        Uint32 texture_format = SDL_PIXELFORMAT_UNKNOWN;
+        if (load->is_font)
+        {
+            components->font = load->font;
+        }
+        else if (load->pack_entry != NULL)
+        {
+            texture_format = load->pack_entry->pixel_format;
+            *textures[asset] = create_sdl_texture_from_asset_pack(core_components->renderer, &asset_pack, load->pack_entry, texture_format);
+        }
+        else if (load->surface != NULL)
+        {
+            texture_format = choose_texture_format(core_components->renderer, load->alpha_type, !core_components->full_color_textures);
+            *textures[asset] = create_sdl_texture_in_format(core_components->renderer, load->surface, texture_format);
+        }
+        else
+        {
+            *textures[asset] = NULL;
+        }
+        Uint64 upload_ticks = SDL_GetPerformanceCounter() - upload_start;
 
-    /* Load LED settings from file. */
-    if (read_settings(app_state) != 0)
-    {
-        SDL_Log("Failed to read settings");
-        return 1;
-    }
-    return 0;
+        if (load->is_font ? load->font == NULL : *textures[asset] == NULL)
+        {
+            SDL_Log("Failed to load %s: %s\n", load->path, load->error[0] != '\0' ? load->error : SDL_GetError());
+            result = 1;
+            continue;
+        }
+        if (load->is_font)
+        {
+            printf("Loaded %s: decode %.2f ms\n", load->path, load->decode_ticks / ticks_per_millisecond);
+            continue;
+        }
+        size_t asset_byte_count = get_texture_byte_count(*textures[asset]);
+        texture_byte_count += asset_byte_count;
+        printf("Loaded %s%s: decode %.2f ms, upload %.2f ms, %s texture %zu KiB\n", load->path, load->pack_entry != NULL ? " from the asset pack" : "",
+               load->decode_ticks / ticks_per_millisecond, upload_ticks / ticks_per_millisecond, SDL_GetPixelFormatName(texture_format),
+               asset_byte_count / 1024);
+    }
+    close_asset_pack(&asset_pack);
+    printf("Startup assets ready in %.2f ms, %zu KiB of image textures\n", (SDL_GetPerformanceCounter() - load_start) / ticks_per_millisecond,
+           texture_byte_count / 1024);
+    return result;
 }
 
 void initialize_config_page_ui(SelectableMenuItems *menu_items, CoreSDLComponents *core_components, AdditionalSDLComponents *components)
@@ -374,12 +655,12 @@ void initialize_config_page_ui(SelectableMenuItems *menu_items, CoreSDLComponent
     menu_items->text_highlight_color = (SDL_Color){255, 173, 99, 255};
     menu_items->item_count = LED_SETTINGS_COUNT;
     menu_items->string_length = STRING_LENGTH;
-    menu_items->menu_text = malloc(menu_items->item_count * sizeof(char *));
-    menu_items->menu_text_textures = malloc(menu_items->item_count * sizeof(SDL_Texture *));
+    menu_items->menu_text = ui_arena_alloc(&components->ui_arena, menu_items->item_count * sizeof(char *));
+    menu_items->menu_text_textures = ui_arena_alloc(&components->ui_arena, menu_items->item_count * sizeof(SDL_Texture *));
 
     for (int setting_index = 0; setting_index < menu_items->item_count; setting_index++)
     {
-        menu_items->menu_text[setting_index] = malloc(menu_items->string_length * sizeof(char));
+        menu_items->menu_text[setting_index] = ui_arena_alloc(&components->ui_arena, menu_items->string_length * sizeof(char));
         /* preload default strings */
         snprintf(menu_items->menu_text[setting_index], menu_items->string_length, "%s", led_setting_option_to_string(setting_index));
 
@@ -395,12 +676,12 @@ void initialize_menu_ui(SelectableMenuItems *menu_items, CoreSDLComponents *core
     menu_items->text_highlight_color = (SDL_Color){255, 173, 99, 255};
     menu_items->item_count = MENU_OPTION_COUNT;
     menu_items->string_length = STRING_LENGTH;
-    menu_items->menu_text = malloc(menu_items->item_count * sizeof(char *));
-    menu_items->menu_text_textures = malloc(menu_items->item_count * sizeof(SDL_Texture *));
+    menu_items->menu_text = ui_arena_alloc(&components->ui_arena, menu_items->item_count * sizeof(char *));
+    menu_items->menu_text_textures = ui_arena_alloc(&components->ui_arena, menu_items->item_count * sizeof(SDL_Texture *));
 
     for (int setting_index = 0; setting_index < menu_items->item_count; setting_index++)
     {
-        menu_items->menu_text[setting_index] = malloc(menu_items->string_length * sizeof(char));
+        menu_items->menu_text[setting_index] = ui_arena_alloc(&components->ui_arena, menu_items->string_length * sizeof(char));
         /* preload default strings */
         snprintf(menu_items->menu_text[setting_index], menu_items->string_length, "%s", menu_option_to_string(setting_index, app_state));
 
@@ -419,75 +700,49 @@ void free_menu_items(SelectableMenuItems *menu_items)
         {
             if (menu_items->menu_text_textures[item_index])
             {
-                SDL_DestroyTexture(menu_items->menu_text_textures[item_index]);
+                destroy_texture(menu_items->menu_text_textures[item_index]);
             }
         }
-        free(menu_items->menu_text_textures);
-    }
-    if (menu_items->menu_text)
-    {
-        for (int item_index = 0; item_index < menu_items->item_count; item_index++)
-        {
-            if (menu_items->menu_text[item_index])
-            {
-                free(menu_items->menu_text[item_index]);
-            }
-        }
-        free(menu_items->menu_text);
     }
+    /* The arrays and strings live in the UI arena, free_ui_arena releases them. */
+    menu_items->menu_text_textures = NULL;
+    menu_items->menu_text = NULL;
 }
 
 void update_config_page_ui_text(SelectableMenuItems *menu_items, const CoreSDLComponents *core_components, const AdditionalSDLComponents *components, const AppState *app_state)
 {
     LedSettingOption selected_setting = app_state->selected_setting;
+    char value_text[STRING_LENGTH];
     for (LedSettingOption setting_index = 0; setting_index < LED_SETTINGS_COUNT; setting_index++)
     {
-        switch (setting_index)
+        LedSettingField field = led_setting_field_for_option(setting_index);
+        if (field != LED_FIELD_COUNT)
+        {
+            /* Rows for schema settings are "<label><value>", with carets around the selected row */
+            const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+            descriptor->format_value(get_led_setting(&app_state->led_settings[app_state->selected_led], field), value_text, sizeof(value_text));
+            snprintf(menu_items->menu_text[setting_index], menu_items->string_length, "%s%s%s%s",
+                     selected_setting == setting_index ? MENU_CARRET_LEFT : "",
+                     descriptor->label,
+                     value_text,
+                     selected_setting == setting_index ? MENU_CARRET_RIGHT : "");
+        }
+        else if (setting_index == SELECTED_LED)
         {
-        case SELECTED_LED:
             snprintf(menu_items->menu_text[setting_index], menu_items->string_length, "%sLED: %s%s",
                      selected_setting == SELECTED_LED ? MENU_CARRET_LEFT : "",
                      led_to_string(app_state->selected_led),
                      selected_setting == SELECTED_LED ? MENU_CARRET_RIGHT : "");
-            break;
-        case BRIGHTNESS:
-            /* Write menu text to string */
-            snprintf(menu_items->menu_text[setting_index],
-                     menu_items->string_length, "%sBrightness: %d%s", selected_setting == BRIGHTNESS ? MENU_CARRET_LEFT : "",
-                     app_state->led_settings[app_state->selected_led].brightness / BRIGHTNESS_INCREMENT,
-                     selected_setting == BRIGHTNESS ? MENU_CARRET_RIGHT : "");
-            break;
-        case EFFECT:
-            snprintf(menu_items->menu_text[setting_index],
-                     menu_items->string_length,
-                     "%sEffect:     %s%s",
-                     selected_setting == EFFECT ? MENU_CARRET_LEFT : "",
-                     animation_effect_to_string(app_state->led_settings[app_state->selected_led].effect),
-                     selected_setting == EFFECT ? MENU_CARRET_RIGHT : "");
-            break;
-        case COLOR:
-            snprintf(menu_items->menu_text[setting_index],
-                     menu_items->string_length, "%sColor:   %s%s",
-                     selected_setting == COLOR ? MENU_CARRET_LEFT : "",
-                     color_to_string(app_state->led_settings[app_state->selected_led].color),
-                     selected_setting == COLOR ? MENU_CARRET_RIGHT : "");
-            break;
-        case DURATION:
-            snprintf(menu_items->menu_text[setting_index],
-                     menu_items->string_length,
-                     "%sDuration: %dms%s",
-                     selected_setting == DURATION ? MENU_CARRET_LEFT : "",
-                     app_state->led_settings[app_state->selected_led].duration,
-                     selected_setting == DURATION ? MENU_CARRET_RIGHT : "");
-            break;
-        case MATCH_SETTINGS:
+        }
+        else if (setting_index == MATCH_SETTINGS)
+        {
             snprintf(menu_items->menu_text[setting_index],
                      menu_items->string_length,
                      "Sync LED colors");
-            break;
         }
 
-        /* Create texture from string */
+        /* Create texture from string, replacing the previous one */
+        destroy_texture(menu_items->menu_text_textures[setting_index]);
         menu_items->menu_text_textures[setting_index] = create_text_texture(core_components->renderer, components->font, selected_setting == setting_index ? &menu_items->text_highlight_color : &menu_items->text_color, &menu_items->text_shadow_color, menu_items->menu_text[setting_index]);
     }
 }
@@ -501,117 +756,67 @@ void update_menu_ui_text(SelectableMenuItems *menu_items, const CoreSDLComponent
         snprintf(menu_items->menu_text[menu_index], menu_items->string_length, "%s%s", selected_menu_option == menu_index ? ">>> " : "",
                  menu_option_to_string(menu_index, app_state));
 
+        destroy_texture(menu_items->menu_text_textures[menu_index]);
         menu_items->menu_text_textures[menu_index] = create_text_texture(core_components->renderer, components->font, selected_menu_option == menu_index ? &menu_items->text_highlight_color : &menu_items->text_color, &menu_items->text_shadow_color, menu_items->menu_text[menu_index]);
     }
 }
-int read_settings(AppState *app_state)
+int initialize_ui_arena(UiArena *arena, size_t capacity)
 {
-    FILE *file = fopen(SETTINGS_FILE, "r");
-    if (!file)
+    /* Zeroed so texture arrays start out NULL. */
+    arena->memory = calloc(1, capacity);
+    arena->capacity = arena->memory != NULL ? capacity : 0;
+    arena->used = 0;
+    if (arena->memory == NULL)
     {
-        perror("fopen");
-        SDL_Log("Failed to open %s for reading", SETTINGS_FILE);
+        perror("calloc");
         return 1;
     }
-
-    char line[STRING_LENGTH];
-    int led_index = -1;
-    SDL_Log("Reading settings from %s ...", SETTINGS_FILE);
-
-    while (fgets(line, sizeof(line), file))
-    {
-        char led_name[STRING_LENGTH];
-        if (sscanf(line, "[%[^]]]", led_name) == 1)
-        {
-            if (strcmp(led_name, "global") == 0)
-            {
-                led_index = -2; // Special index for global settings
-            }
-            else
-            {
-                led_index = internal_led_name_to_led(led_name);
-            }
-            continue;
-        }
-
-        if (led_index == -2)
-        {
-            // Handle global settings
-            int temp_value;
-            if (sscanf(line, "should_enable_low_battery_indication=%d", &temp_value) == 1)
-            {
-                app_state->should_enable_low_battery_indication = (temp_value != 0) ? true : false;
-            }
-        }
-        else if (led_index >= 0 && led_index < LED_COUNT)
-        {
-            sscanf(line, "brightness=%d", &app_state->led_settings[led_index].brightness);
-            sscanf(line, "color=%x", &app_state->led_settings[led_index].color);
-            sscanf(line, "duration=%d", &app_state->led_settings[led_index].duration);
-            sscanf(line, "effect=%d", (int *)&app_state->led_settings[led_index].effect);
-
-            /* Bounds checking */
-            app_state->led_settings[led_index].brightness =
-                clamp(app_state->led_settings[led_index].brightness, 0, MAX_BRIGHTNESS);
-            app_state->led_settings[led_index].color =
-                clamp(app_state->led_settings[led_index].color, 0, 0xFFFFFF);
-            app_state->led_settings[led_index].duration =
-                clamp(app_state->led_settings[led_index].duration, 0, MAX_DURATION);
-            app_state->led_settings[led_index].effect =
-                clamp(app_state->led_settings[led_index].effect, 0, ANIMATION_EFFECT_COUNT - 1);
-        }
-    }
-    SDL_Log("Settings read successfully");
-
-    fclose(file);
     return 0;
 }
 
-int save_settings(AppState *app_state)
+void *ui_arena_alloc(UiArena *arena, size_t size)
 {
-    app_state->should_save_settings = false;
-    FILE *file = fopen(SETTINGS_FILE, "w");
-    if (!file)
+    size_t start = (arena->used + UI_ARENA_ALIGNMENT - 1) / UI_ARENA_ALIGNMENT * UI_ARENA_ALIGNMENT;
+    if (arena->memory == NULL || start + size > arena->capacity)
     {
-        perror("fopen");
-        SDL_Log("Failed to open %s for writing", SETTINGS_FILE);
-        return 1;
-    }
-
-    SDL_Log("Saving settings to %s ...", SETTINGS_FILE);
-
-    // Save global settings first
-    fprintf(file, "[global]\n");
-    fprintf(file, "should_enable_low_battery_indication=%d\n\n", app_state->should_enable_low_battery_indication);
-
-    // Save LED-specific settings
-    for (int led_index = 0; led_index < LED_COUNT; led_index++)
-    {
-        fprintf(file, "[%s]\n", led_internal_name(led_index));
-        fprintf(file, "brightness=%d\n", app_state->led_settings[led_index].brightness);
-        fprintf(file, "color=0x%06X\n", app_state->led_settings[led_index].color);
-        fprintf(file, "duration=%d\n", app_state->led_settings[led_index].duration);
-        fprintf(file, "effect=%d\n\n", app_state->led_settings[led_index].effect);
+        SDL_Log("UI arena is out of space, %zu of %zu bytes used and %zu more requested", arena->used, arena->capacity, size);
+        return NULL;
     }
-    SDL_Log("Settings saved successfully");
-
-    fclose(file);
-    return 0;
+    arena->used = start + size;
+    return arena->memory + start;
 }
 
-int initialize_brick_sprite(Sprite *brick_sprite, SDL_Renderer *renderer)
+void free_ui_arena(UiArena *arena)
 {
-    /* Load the brick sprite image to a texture */
+    free(arena->memory);
+    *arena = (UiArena){0};
+}
 
-    brick_sprite->sprite_texture = create_sdl_texture_from_image(renderer, BRICK_SPRITE_SHEET_PATH);
+int initialize_brick_sprite(Sprite *brick_sprite, SDL_Texture *sprite_sheet_texture, SpriteAtlas *sprite_atlas, UiArena *arena)
+{
+    /* Decoded and uploaded with the other startup assets */
+    brick_sprite->sprite_texture = sprite_sheet_texture;
+    brick_sprite->atlas = *sprite_atlas;
+    *sprite_atlas = (SpriteAtlas){0};
     if (!brick_sprite->sprite_texture)
     {
-        SDL_Log("Failed to load brick sprite texture from %s", BRICK_SPRITE_SHEET_PATH);
+        SDL_Log("Failed to load brick sprite texture from %s", brick_sprite->atlas.frames != NULL ? BRICK_SPRITE_ATLAS_PATH : BRICK_SPRITE_SHEET_PATH);
+        return 1;
+    }
+    if (brick_sprite->atlas.frames != NULL &&
+        (brick_sprite->atlas.frame_count < BRICK_SPRITE_FRAME_COUNT || brick_sprite->atlas.frame_width != BRICK_SPRITE_WIDTH ||
+         brick_sprite->atlas.frame_height != BRICK_SPRITE_HEIGHT))
+    {
+        SDL_Log("%s doesn't match the brick sprite sheet, rebuild it with make sprite_atlas", BRICK_SPRITE_ATLAS_INDEX_PATH);
         return 1;
     }
 
     /* We have one animation for each LED. */
-    brick_sprite->animations = (AnimationInfo *)malloc(sizeof(AnimationInfo) * LED_COUNT);
+    brick_sprite->animations = ui_arena_alloc(arena, sizeof(AnimationInfo) * LED_COUNT);
+    if (!brick_sprite->animations)
+    {
+        return 1;
+    }
     brick_sprite->animation_count = LED_COUNT;
     brick_sprite->sprite_width = BRICK_SPRITE_WIDTH;
     brick_sprite->sprite_height = BRICK_SPRITE_HEIGHT;
@@ -629,16 +834,20 @@ int initialize_brick_sprite(Sprite *brick_sprite, SDL_Renderer *renderer)
     return 0;
 }
 
-void render_frame(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, bool verbose_logging_enabled)
+void render_frame(AppState *app_state, CoreSDLComponents *core_components, AdditionalSDLComponents *components, Sprite *brick_sprite, SelectableMenuItems *config_page_ui, SelectableMenuItems *menu_page_ui, Uint32 frame_millis, bool verbose_logging_enabled)
 {
+    trace_begin("render_frame");
+    /* Everything below is queued, runs that share a texture are drawn with one call. */
+    RenderBatch *batch = &core_components->render_batch;
+
     /* Clear screen */
     SDL_RenderClear(core_components->renderer);
 
     /* Render background texture */
-    SDL_RenderCopy(core_components->renderer, components->backgroundTexture, NULL, NULL);
+    render_batch_copy(batch, components->backgroundTexture, NULL, NULL);
 
     /* Render the user-selected color in front of a black square */
-    render_colored_square(app_state, core_components);
+    render_colored_square(app_state, core_components, frame_millis);
 
     char log_message[STRING_LENGTH];
     snprintf(log_message, sizeof(log_message), "Selected LED: %d\n", app_state->selected_led);
@@ -646,54 +855,52 @@ void render_frame(AppState *app_state, CoreSDLComponents *core_components, Addit
 
     /* Render brick sprite */
     brick_sprite->current_animation_index = app_state->selected_led;
-    update_sprite_render(core_components->renderer, brick_sprite, 10, 99);
+    update_sprite_render(batch, brick_sprite, 10, 99, frame_millis);
 
     /* Render the interactable user interface. */
-    render_menu_items(core_components->renderer, config_page_ui, 550, 150);
+    render_menu_items(batch, config_page_ui, 550, 150);
 
     if (app_state->current_page == MENU_PAGE)
     { /* Render menu last on stack if it needs to show*/
-        SDL_RenderCopy(core_components->renderer, components->menuTexture, NULL, NULL);
-        render_menu_items(core_components->renderer, menu_page_ui, 200, 210);
+        render_batch_copy(batch, components->menuTexture, NULL, NULL);
+        render_menu_items(batch, menu_page_ui, 200, 210);
     }
     /* Main render call to update screen */
+    render_batch_flush(batch);
     SDL_RenderPresent(core_components->renderer);
-
-    /* Delay to control frame rate Approximately 60 frames per second */
-    SDL_Delay(16);
+    trace_end("render_frame");
 }
 
-void render_colored_square(AppState *app_state, CoreSDLComponents *core_components)
+void render_colored_square(AppState *app_state, CoreSDLComponents *core_components, Uint32 frame_millis)
 {
     /* Adjusted to add 4 pixels on top */
     SDL_Rect black_rect = {20, 96, BRICK_SPRITE_WIDTH, BRICK_SPRITE_HEIGHT + 4};
     /* Black color */
-    SDL_SetRenderDrawColor(core_components->renderer, 0, 0, 0, 255);
-    SDL_RenderFillRect(core_components->renderer, &black_rect);
+    render_batch_fill_rect(&core_components->render_batch, &black_rect, (SDL_Color){0, 0, 0, 255});
     /* Adjusted to match the new black_rect */
 
+    /* Show what the LED does right now, the effect's curve scales the color like the firmware would. */
     SDL_Rect color_rect = {25, 101, BRICK_SPRITE_WIDTH - 10, BRICK_SPRITE_HEIGHT - 6};
-    int32_t color = app_state->led_settings[app_state->selected_led].color;
-    SDL_SetRenderDrawColor(core_components->renderer, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, 255);
-    SDL_RenderFillRect(core_components->renderer, &color_rect);
+    uint32_t color = led_effect_color(&app_state->led_settings[app_state->selected_led], frame_millis);
+    render_batch_fill_rect(&core_components->render_batch, &color_rect, (SDL_Color){(color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, 255});
 }
 
-void render_text_texture(SDL_Renderer *renderer, SDL_Texture *texture, int x, int y)
+void render_text_texture(RenderBatch *batch, SDL_Texture *texture, int x, int y)
 {
     int text_width, text_height;
     SDL_QueryTexture(texture, NULL, NULL, &text_width, &text_height);
     SDL_Rect dstrect = {x, y, text_width, text_height};
-    SDL_RenderCopy(renderer, texture, NULL, &dstrect);
+    render_batch_copy(batch, texture, NULL, &dstrect);
 }
 
-void render_menu_items(SDL_Renderer *renderer, SelectableMenuItems *menu_items, int start_x, int start_y)
+void render_menu_items(RenderBatch *batch, SelectableMenuItems *menu_items, int start_x, int start_y)
 {
     /* x and y UI element spacing. */
     const int x_offset = 20;
     const int y_offset = 60;
     for (int item_index = 0; item_index < menu_items->item_count; item_index++)
     {
-        render_text_texture(renderer, menu_items->menu_text_textures[item_index], start_x + x_offset, start_y + y_offset * item_index);
+        render_text_texture(batch, menu_items->menu_text_textures[item_index], start_x + x_offset, start_y + y_offset * item_index);
     }
 }
 
@@ -709,161 +916,20 @@ SDL_Surface *load_image(const char *image_name)
     return surface;
 }
 
-void write_max_scale_data(FILE *file, const AppState *app_state, const Led led, char *filepath)
-{
-    if (led == LED_TOP)
-    {
-        snprintf(filepath, STRING_LENGTH, "%s/max_scale", SYS_FILE_PATH);
-    }
-    else
-    {
-        snprintf(filepath, STRING_LENGTH, "%s/max_scale_%s", SYS_FILE_PATH, led_internal_name(led));
-    }
-
-    file = fopen(filepath, "w");
-    if (file != NULL)
-    {
-        fprintf(file, "%d\n", app_state->led_settings[led].brightness);
-        fclose(file);
-    }
-    else
-    {
-        SDL_Log("Failed to open file: %s", filepath);
-    }
-}
-
-void write_effect_data(FILE *file, const AppState *app_state, const Led led, char *filepath)
-{
-    const char *led_suffix[1] = {led_internal_name(led)};
-    const char **suffix_array = (led == LED_FRONT) ? front_led_suffix : led_suffix;
-
-    for (int suffix_index = 0; suffix_index < (led == LED_FRONT ? 2 : 1); suffix_index++)
-    {
-        snprintf(filepath, STRING_LENGTH, "%s/effect_%s", SYS_FILE_PATH, suffix_array[suffix_index]);
-        file = fopen(filepath, "w");
-        if (file != NULL)
-        {
-            fprintf(file, "%d\n", app_state->led_settings[led].effect);
-            fclose(file);
-        }
-        else
-        {
-            SDL_Log("Failed to open file: %s", filepath);
-        }
-    }
-}
-
-void write_effect_duration_data(FILE *file, const AppState *app_state, const Led led, char *filepath)
-{
-    const char *led_suffix[1] = {led_internal_name(led)};
-    const char **suffix_array = (led == LED_FRONT) ? front_led_suffix : led_suffix;
-
-    for (int suffix_index = 0; suffix_index < (led == LED_FRONT ? 2 : 1); suffix_index++)
-    {
-        snprintf(filepath, STRING_LENGTH, "%s/effect_duration_%s", SYS_FILE_PATH, suffix_array[suffix_index]);
-        file = fopen(filepath, "w");
-        if (file != NULL)
-        {
-            fprintf(file, "%d\n", app_state->led_settings[led].duration);
-            fclose(file);
-        }
-        else
-        {
-            SDL_Log("Failed to open file: %s", filepath);
-        }
-    }
-}
-
-void write_color_data(FILE *file, const AppState *app_state, const Led led, char *filepath)
-{
-    const char *led_suffix[1] = {led_internal_name(led)};
-    const char **suffix_array = (led == LED_FRONT) ? front_led_suffix : led_suffix;
-
-    for (int suffix_index = 0; suffix_index < (led == LED_FRONT ? 2 : 1); suffix_index++)
-    {
-        snprintf(filepath, STRING_LENGTH, "%s/effect_rgb_hex_%s", SYS_FILE_PATH, suffix_array[suffix_index]);
-        file = fopen(filepath, "w");
-        if (file != NULL)
-        {
-
-            fprintf(file, "%06X\n", app_state->led_settings[led].color);
-
-            fclose(file);
-        }
-        else
-        {
-            SDL_Log("Failed to open file: %s", filepath);
-        }
-    }
-}
-
-void update_leds(AppState *app_state)
-{
-    char filepath[STRING_LENGTH];
-    FILE *file = NULL;
-
-    app_state->should_update_leds = false;
-    for (Led led = 0; led < LED_COUNT; led++)
-    {
-        write_max_scale_data(file, app_state, led, filepath);
-        write_color_data(file, app_state, led, filepath);
-        write_effect_duration_data(file, app_state, led, filepath);
-        write_effect_data(file, app_state, led, filepath);
-    }
-}
-
-void install_daemon()
-{
-    system("sh scripts/install.sh");
-}
-
-void uninstall_daemon()
-{
-    system("sh scripts/uninstall.sh");
-}
-
-void color_match_leds(AppState *app_state)
-{
-    for (Led led = 0; led < LED_COUNT; led++)
-    {
-        app_state->led_settings[led].color = app_state->led_settings[app_state->selected_led].color;
-    }
-}
-
-void turn_off_all_leds(AppState *app_state)
-{
-    for (Led led = 0; led < LED_COUNT; led++)
-    {
-        app_state->led_settings[led].brightness = 0;
-        app_state->led_settings[led].effect = DISABLE;
-    }
-    update_leds(app_state);
-    system("sh scripts/turn_off_all_leds.sh");
-}
-
-void turn_on_all_leds(AppState *app_state)
-{
-    for (Led led = 0; led < LED_COUNT; led++)
-    {
-        app_state->led_settings[led].brightness = MAX_BRIGHTNESS;
-        app_state->led_settings[led].effect = STATIC;
-    }
-    update_leds(app_state);
-    system("sh scripts/turn_on_all_leds.sh");
-}
-
 int teardown(CoreSDLComponents *core_components, AdditionalSDLComponents *components,
              SelectableMenuItems *config_menu_items, SelectableMenuItems *main_menu_items, Sprite *brick_sprite, AppState *app_state)
 {
     free_menu_items(config_menu_items);
     free_menu_items(main_menu_items);
     free_sprite(brick_sprite);
+    free_ui_arena(&components->ui_arena);
+    /* Textures belong to the renderer, destroy them before free_sdl_core destroys it. */
+    destroy_texture(components->backgroundTexture);
+    destroy_texture(components->menuTexture);
     free_sdl_core(core_components);
-    SDL_DestroyTexture(components->backgroundTexture);
-    SDL_DestroyTexture(components->menuTexture);
     TTF_CloseFont(components->font);
     IMG_Quit();
     TTF_Quit();
     SDL_Quit();
-    return app_state->should_install_daemon ? 0 : 66;
+    return app_state->should_install_daemon ? 0 : UNINSTALL_EXIT_CODE;
 }
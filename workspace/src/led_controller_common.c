@@ -1,4 +1,6 @@
-#include "led_controller_common.h"
+#include "led_core.h"
+#include <stdio.h>
+#include <string.h>
 
 const char *animation_effect_to_string(AnimationEffect effect)
 {
@@ -70,85 +72,158 @@ const char *color_to_string(uint32_t color)
   }
 }
 
-uint32_t next_color(uint32_t color, int sign)
+/* Wheel entry offset (0-254) within segment (0-5), rising channels count up and falling ones down.
+ * Offset 255 would be offset 0 of the next segment, so the table stops one short of it. */
+#define HUE_WHEEL_ENTRY(segment, offset)                              \
+  ((segment) == 0   ? 0xFF0000u | ((uint32_t)(offset) << 8)          \
+   : (segment) == 1 ? ((uint32_t)(255 - (offset)) << 16) | 0x00FF00u \
+   : (segment) == 2 ? 0x00FF00u | (uint32_t)(offset)                 \
+   : (segment) == 3 ? ((uint32_t)(255 - (offset)) << 8) | 0x0000FFu  \
+   : (segment) == 4 ? ((uint32_t)(offset) << 16) | 0x0000FFu         \
+                    : 0xFF0000u | (uint32_t)(255 - (offset)))
+#define HUE_WHEEL_15(segment, base)                                                                                            \
+  HUE_WHEEL_ENTRY(segment, (base) + 0), HUE_WHEEL_ENTRY(segment, (base) + 1), HUE_WHEEL_ENTRY(segment, (base) + 2),           \
+      HUE_WHEEL_ENTRY(segment, (base) + 3), HUE_WHEEL_ENTRY(segment, (base) + 4), HUE_WHEEL_ENTRY(segment, (base) + 5),       \
+      HUE_WHEEL_ENTRY(segment, (base) + 6), HUE_WHEEL_ENTRY(segment, (base) + 7), HUE_WHEEL_ENTRY(segment, (base) + 8),       \
+      HUE_WHEEL_ENTRY(segment, (base) + 9), HUE_WHEEL_ENTRY(segment, (base) + 10), HUE_WHEEL_ENTRY(segment, (base) + 11),     \
+      HUE_WHEEL_ENTRY(segment, (base) + 12), HUE_WHEEL_ENTRY(segment, (base) + 13), HUE_WHEEL_ENTRY(segment, (base) + 14),
+#define HUE_WHEEL_16(segment, base) HUE_WHEEL_15(segment, base) HUE_WHEEL_ENTRY(segment, (base) + 15),
+#define HUE_WHEEL_SEGMENT(segment)                                                                                             \
+  HUE_WHEEL_16(segment, 0) HUE_WHEEL_16(segment, 16) HUE_WHEEL_16(segment, 32) HUE_WHEEL_16(segment, 48)                      \
+  HUE_WHEEL_16(segment, 64) HUE_WHEEL_16(segment, 80) HUE_WHEEL_16(segment, 96) HUE_WHEEL_16(segment, 112)                    \
+  HUE_WHEEL_16(segment, 128) HUE_WHEEL_16(segment, 144) HUE_WHEEL_16(segment, 160) HUE_WHEEL_16(segment, 176)                 \
+  HUE_WHEEL_16(segment, 192) HUE_WHEEL_16(segment, 208) HUE_WHEEL_16(segment, 224) HUE_WHEEL_15(segment, 240)
+
+/* Built by the compiler, every entry is a distinct color. */
+static const uint32_t hue_wheel[HUE_WHEEL_SIZE] = {
+    HUE_WHEEL_SEGMENT(0) HUE_WHEEL_SEGMENT(1) HUE_WHEEL_SEGMENT(2) HUE_WHEEL_SEGMENT(3) HUE_WHEEL_SEGMENT(4) HUE_WHEEL_SEGMENT(5)};
+
+static int wrap_hue_index(int hue_index)
+{
+  hue_index %= HUE_WHEEL_SIZE;
+  return hue_index < 0 ? hue_index + HUE_WHEEL_SIZE : hue_index;
+}
+
+uint32_t hue_wheel_color(int hue_index)
 {
-  int16_t r = (color >> 16) & 0xFF;
-  int16_t g = (color >> 8) & 0xFF;
-  int16_t b = color & 0xFF;
+  return hue_wheel[wrap_hue_index(hue_index)];
+}
+
+uint32_t hsv_color(int hue_index, int saturation, int value)
+{
+  uint32_t pure_color = hue_wheel_color(hue_index);
+  saturation = clamp(saturation, 0, 255);
+  value = clamp(value, 0, 255);
+  uint32_t color = 0;
+  for (int shift = 0; shift <= 16; shift += 8)
+  {
+    /* Pull the channel towards white by (255 - saturation), then scale it by value, rounded. */
+    int channel = (pure_color >> shift) & 0xFF;
+    int desaturated = 255 * 255 - saturation * (255 - channel);
+    color |= (uint32_t)((value * desaturated + 255 * 255 / 2) / (255 * 255)) << shift;
+  }
+  return color;
+}
 
-  // Red -> Yellow -> Green -> Cyan -> Blue -> Magenta -> Red
-  if (r == 255 && g < 255 && b == 0)
-  { // Red to Yellow
-    g = (g + sign * COLOR_CYLCE_INCREMENT);
-    if (g > 255)
-      g = 255;
-    if (g < 0)
-      g = 0;
+void color_to_hsv(uint32_t color, int *hue_index, int *saturation, int *value)
+{
+  int r = (color >> 16) & 0xFF;
+  int g = (color >> 8) & 0xFF;
+  int b = color & 0xFF;
+  int maximum = r > g ? (r > b ? r : b) : (g > b ? g : b);
+  int minimum = r < g ? (r < b ? r : b) : (g < b ? g : b);
+  int range = maximum - minimum;
+  if (saturation != NULL)
+  {
+    *saturation = maximum > 0 ? (range * 255 + maximum / 2) / maximum : 0;
   }
-  else if (r > 0 && g == 255 && b == 0)
-  { // Yellow to Green
-    r = (r - sign * COLOR_CYLCE_INCREMENT);
-    if (r > 255)
-      r = 255;
-    if (r < 0)
-      r = 0;
+  if (value != NULL)
+  {
+    *value = maximum;
+  }
+  if (range == 0)
+  {
+    *hue_index = 0;
+    return;
+  }
+
+  /* Which channels are largest and smallest picks the segment, the third channel the offset in it. */
+  int segment;
+  int middle;
+  if (r == maximum && b == minimum)
+  {
+    segment = 0;
+    middle = g;
   }
-  else if (g == 255 && r == 0 && b < 255)
-  { // Green to Cyan
-    b = (b + sign * COLOR_CYLCE_INCREMENT);
-    if (b > 255)
-      b = 255;
-    if (b < 0)
-      b = 0;
+  else if (g == maximum && b == minimum)
+  {
+    segment = 1;
+    middle = r;
   }
-  else if (g > 0 && b == 255 && r == 0)
-  { // Cyan to Blue
-    g = (g - sign * COLOR_CYLCE_INCREMENT);
-    if (g > 255)
-      g = 255;
-    if (g < 0)
-      g = 0;
+  else if (g == maximum && r == minimum)
+  {
+    segment = 2;
+    middle = b;
   }
-  else if (b == 255 && g == 0 && r < 255)
-  { // Blue to Magenta
-    r = (r + sign * COLOR_CYLCE_INCREMENT);
-    if (r > 255)
-      r = 255;
-    if (r < 0)
-      r = 0;
+  else if (b == maximum && r == minimum)
+  {
+    segment = 3;
+    middle = g;
   }
-  else if (r == 255 && g == 0 && b > 0)
-  { // Magenta to Red
-    b = (b - sign * COLOR_CYLCE_INCREMENT);
-    if (b > 255)
-      b = 255;
-    if (b < 0)
-      b = 0;
+  else if (b == maximum && g == minimum)
+  {
+    segment = 4;
+    middle = r;
   }
   else
-  { // Initialize to red if no valid state
-    r = 255;
-    g = 0;
-    b = 0;
+  {
+    segment = 5;
+    middle = b;
+  }
+  int offset = ((middle - minimum) * 255 + range / 2) / range;
+  /* Segments 1, 3 and 5 count the middle channel down, offset 255 is the start of the next segment. */
+  *hue_index = wrap_hue_index(segment * HUE_SEGMENT_LENGTH + (segment % 2 == 0 ? offset : HUE_SEGMENT_LENGTH - offset));
+}
+
+uint32_t sweep_color(HueSweep *sweep, uint32_t color, int hue_steps)
+{
+  if (!sweep->is_active || sweep->color != color)
+  {
+    color_to_hsv(color, &sweep->hue_index, &sweep->saturation, &sweep->value);
+    if (sweep->saturation == 0)
+    {
+      /* Grays (and black) have no hue to move along, start from the pure color at this value. */
+      sweep->saturation = 255;
+      sweep->value = sweep->value > 0 ? sweep->value : 255;
+    }
+    sweep->is_active = true;
   }
-  return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+
+  sweep->hue_index = wrap_hue_index(sweep->hue_index + hue_steps);
+  sweep->color = hsv_color(sweep->hue_index, sweep->saturation, sweep->value);
+  return sweep->color;
+}
+
+uint32_t next_color(uint32_t color, int hue_steps)
+{
+  HueSweep sweep = {0};
+  return sweep_color(&sweep, color, hue_steps);
 }
 
 const char *led_setting_option_to_string(LedSettingOption setting)
 {
+  LedSettingField field = led_setting_field_for_option(setting);
+  if (field != LED_FIELD_COUNT)
+  {
+    return led_setting_descriptors[field].label;
+  }
+
   switch (setting)
   {
   case SELECTED_LED:
     return "LED: ";
-    break;
-  case BRIGHTNESS:
-    return "Brightness: ";
-  case EFFECT:
-    return "Effect:     ";
-  case COLOR:
-    return "Color       ";
-  case DURATION:
-    return "Duration:   ";
+  case MATCH_SETTINGS:
+    return "Sync LED colors";
   default:
     return "UNKNOWN     ";
   }
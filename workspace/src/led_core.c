@@ -0,0 +1,1076 @@
+#include "led_core.h"
+#include "installer.h"
+#include "trace.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The list of colors we support */
+const uint32_t colors[] = {
+
+    // White
+    0xFFFFFF, // White
+    // Greens
+    0x00FF00, // Green
+    0x00FF80, // Aqua
+
+    // Yellows
+    0xFFFF00, // Yellow
+    0x808000, // Olive
+
+    // Blues
+    0x0000FF, // Blue
+    0x0080FF, // Sky Blue
+
+    // Cyans
+    0x00FFFF, // Cyan
+    0x008080, // Teal
+
+    // Oranges
+    0xFF8000, // Orange
+    // Reds
+    0xFF0000, // Red
+    // Magentas
+    0xFF00FF, // Magenta
+    0xFF80C0, // Light Magenta
+    // Pinks
+    0xFF0080, // Hot Pink
+
+    0xFF8080, // Light Red
+};
+
+const int num_color = sizeof(colors) / sizeof(colors[0]);
+
+/* Array of the split suffixs that sont front led files end in*/
+const char *front_led_suffix[2] = {"f1", "f2"};
+
+/* Directory the LED writers write to, swapped for a fake tree with --sys-root */
+const char *led_sys_file_path = SYS_FILE_PATH;
+
+/* Settings file read_settings and save_settings use */
+const char *settings_file_path = SETTINGS_FILE;
+
+/* Number of LED system files written this session */
+unsigned long led_sys_file_write_count = 0;
+
+static void format_brightness_value(int value, char *buffer, size_t buffer_size)
+{
+    /* Shown in steps of BRIGHTNESS_INCREMENT, i.e 0-10 */
+    snprintf(buffer, buffer_size, "%d", value / BRIGHTNESS_INCREMENT);
+}
+
+static void format_color_value(int value, char *buffer, size_t buffer_size)
+{
+    snprintf(buffer, buffer_size, "%s", color_to_string(value));
+}
+
+static void format_duration_value(int value, char *buffer, size_t buffer_size)
+{
+    snprintf(buffer, buffer_size, "%dms", value);
+}
+
+static void format_effect_value(int value, char *buffer, size_t buffer_size)
+{
+    snprintf(buffer, buffer_size, "%s", animation_effect_to_string(value));
+}
+
+#define LED_SETTINGS_DESCRIPTOR(type, field, FIELD_ID, option, key, minimum, maximum, step, base, label, sysfs_attribute, splits_front_led, ini_format, sysfs_format, format_value) \
+    [FIELD_ID] = {key, sizeof(key) - 1, option, minimum, maximum, step, base, label, sysfs_attribute, splits_front_led, ini_format, sysfs_format, format_value},
+
+const LedSettingDescriptor led_setting_descriptors[LED_FIELD_COUNT] = {
+    LED_SETTINGS_SCHEMA(LED_SETTINGS_DESCRIPTOR)
+};
+
+/* Hash of the settings text last read from or written to settings_file_path */
+static uint64_t persisted_settings_hash = 0;
+static bool has_persisted_settings_hash = false;
+
+LedSettingField led_setting_field_for_option(LedSettingOption option)
+{
+    switch (option)
+    {
+#define LED_SETTINGS_OPTION_CASE(type, field, FIELD_ID, option, ...) \
+    case option:                                                      \
+        return FIELD_ID;
+        LED_SETTINGS_SCHEMA(LED_SETTINGS_OPTION_CASE)
+#undef LED_SETTINGS_OPTION_CASE
+    default:
+        return LED_FIELD_COUNT;
+    }
+}
+
+int get_led_setting(const LedSettings *settings, LedSettingField field)
+{
+    switch (field)
+    {
+#define LED_SETTINGS_GET_CASE(type, field, FIELD_ID, ...) \
+    case FIELD_ID:                                       \
+        return (int)settings->field;
+        LED_SETTINGS_SCHEMA(LED_SETTINGS_GET_CASE)
+#undef LED_SETTINGS_GET_CASE
+    default:
+        return 0;
+    }
+}
+
+bool set_led_setting(AppState *app_state, Led led, LedSettingField field, int value)
+{
+    const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+    LedSettings *settings = &app_state->led_settings[led];
+    value = clamp(value, descriptor->minimum, descriptor->maximum);
+    if (get_led_setting(settings, field) == value)
+    {
+        return false;
+    }
+
+    switch (field)
+    {
+#define LED_SETTINGS_SET_CASE(type, field, FIELD_ID, ...) \
+    case FIELD_ID:                                       \
+        settings->field = (type)value;                   \
+        break;
+        LED_SETTINGS_SCHEMA(LED_SETTINGS_SET_CASE)
+#undef LED_SETTINGS_SET_CASE
+    default:
+        return false;
+    }
+    app_state->dirty_led_fields[led] |= 1u << field;
+    return true;
+}
+
+void handle_user_input(InputType user_input, AppState *app_state)
+{
+    switch (app_state->current_page)
+    {
+    case CONFIG_PAGE:
+    {
+        switch (user_input)
+        {
+        case POWER:
+            /* power button safely exits app */
+            app_state->should_quit = true;
+            break;
+        case START:
+        case SELECT:
+            app_state->current_page = MENU_PAGE;
+            break;
+            break;
+        case A:
+            handle_change_setting(app_state, 0);
+            app_state->should_update_leds = true;
+            break;
+        case B:
+            switch (app_state->current_page)
+            {
+            case MENU_PAGE:
+                /* close menu */
+                app_state->current_page = CONFIG_PAGE;
+                break;
+            case CONFIG_PAGE:
+                /* exit app */
+                app_state->should_quit = true;
+                break;
+            }
+            break;
+        case DPAD_UP:
+            /* Switch between settings */
+            app_state->selected_setting = (app_state->selected_setting - 1 + LED_SETTINGS_COUNT) % LED_SETTINGS_COUNT;
+            break;
+        case DPAD_DOWN:
+            /* Switch between settings */
+            app_state->selected_setting = (app_state->selected_setting + 1 + LED_SETTINGS_COUNT) % LED_SETTINGS_COUNT;
+            break;
+        case DPAD_RIGHT:
+            handle_change_setting(app_state, 1);
+            app_state->should_update_leds = true;
+            break;
+        case DPAD_LEFT:
+            handle_change_setting(app_state, -1);
+            app_state->should_update_leds = true;
+            break;
+        case SWEEP_RIGHT:
+            handle_sweep_setting(app_state, 1);
+            app_state->should_update_leds = true;
+            break;
+        case SWEEP_LEFT:
+            handle_sweep_setting(app_state, -1);
+            app_state->should_update_leds = true;
+            break;
+        case L1:
+        case L2:
+        case L3:
+            app_state->selected_led = (app_state->selected_led - 1 + LED_COUNT) % LED_COUNT;
+            break;
+        case R1:
+        case R2:
+        case R3:
+            app_state->selected_led = (app_state->selected_led + 1) % LED_COUNT;
+            break;
+        default:
+            break;
+        }
+    }
+    break;
+    case MENU_PAGE:
+    {
+        switch (user_input)
+        {
+        case START:
+        case SELECT:
+        case B:
+            app_state->current_page = CONFIG_PAGE;
+            break;
+        case A:
+            handle_menu_select(app_state, app_state->selected_menu_option);
+            break;
+        case DPAD_UP:
+            /* Switch between settings */
+            app_state->selected_menu_option = (app_state->selected_menu_option - 1 + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
+            break;
+        case DPAD_DOWN:
+            /* Switch between settings */
+            app_state->selected_menu_option = (app_state->selected_menu_option + 1 + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
+            break;
+        default:
+            break;
+        }
+    }
+    break;
+    }
+}
+
+int sweep_steps_per_second(const AppState *app_state)
+{
+    if (app_state->current_page != CONFIG_PAGE)
+    {
+        return 0;
+    }
+    if (app_state->selected_setting == COLOR && app_state->are_extended_colors_enabled)
+    {
+        return SWEEP_HUE_STEPS_PER_SECOND;
+    }
+    return app_state->selected_setting == BRIGHTNESS ? SWEEP_BRIGHTNESS_STEPS_PER_SECOND : 0;
+}
+
+void handle_sweep_setting(AppState *app_state, int steps)
+{
+    if (sweep_steps_per_second(app_state) == 0)
+    {
+        /* The row changed under a recorded sweep, treat it like a D-pad press. */
+        handle_change_setting(app_state, steps);
+        return;
+    }
+
+    app_state->should_save_settings = true;
+    const LedSettings *selected_led_settings = &app_state->led_settings[app_state->selected_led];
+    if (app_state->selected_setting == COLOR)
+    {
+        set_led_setting(app_state, app_state->selected_led, LED_FIELD_COLOR, sweep_color(&app_state->hue_sweep, selected_led_settings->color, steps));
+    }
+    else
+    {
+        set_led_setting(app_state, app_state->selected_led, LED_FIELD_BRIGHTNESS, selected_led_settings->brightness + steps);
+    }
+}
+
+void handle_change_setting(AppState *app_state, int change)
+{
+    /* save_settings skips the write if this didn't actually change anything. */
+    app_state->should_save_settings = true;
+    LedSettings *selected_led_settings = &app_state->led_settings[app_state->selected_led];
+    LedSettingField field = led_setting_field_for_option(app_state->selected_setting);
+    switch (app_state->selected_setting)
+    {
+    case SELECTED_LED:
+    {
+        app_state->selected_led = (app_state->selected_led - change + LED_COUNT) % LED_COUNT;
+        break;
+    }
+    case COLOR:
+    {
+        if (app_state->are_extended_colors_enabled)
+        {
+            set_led_setting(app_state, app_state->selected_led, LED_FIELD_COLOR, next_color(selected_led_settings->color, change * COLOR_CYLCE_INCREMENT));
+        }
+        else
+        {
+            /* Find the current color index in colors */
+            int current_color_index = -1;
+            for (int i = 0; i < num_color; i++)
+            {
+                if (colors[i] == selected_led_settings->color)
+                {
+                    current_color_index = i;
+                    break;
+                }
+            }
+
+            /* If the current color is not found, default to the first color */
+            if (current_color_index == -1)
+            {
+                current_color_index = 0;
+            }
+
+            /* Update the color index based on the change */
+            current_color_index = (current_color_index + change + num_color) % num_color;
+
+            /* Set the new color */
+            set_led_setting(app_state, app_state->selected_led, LED_FIELD_COLOR, colors[current_color_index]);
+        }
+    }
+    break;
+    case MATCH_SETTINGS:
+        /* Change was from the user selecting the A button*/
+        if (change == 0)
+        {
+            color_match_leds(app_state);
+        }
+        break;
+    default:
+        /* Schema driven settings step by their step size and never wrap around, looping
+         * from max brightness to 0 brightness feels bad. */
+        if (field != LED_FIELD_COUNT)
+        {
+            set_led_setting(app_state, app_state->selected_led, field,
+                            get_led_setting(selected_led_settings, field) + change * led_setting_descriptors[field].step);
+        }
+        break;
+    }
+}
+
+void handle_menu_select(AppState *app_state, MenuOption selected_menu_option)
+{
+    switch (selected_menu_option)
+    {
+    case ENABLE_ALL:
+        turn_on_all_leds(app_state);
+        app_state->should_save_settings = true;
+        break;
+    case DISABLE_ALL:
+        turn_off_all_leds(app_state);
+        app_state->should_save_settings = true;
+        break;
+    case TOGGLE_EXTENDED_COLORS:
+        app_state->are_extended_colors_enabled = !app_state->are_extended_colors_enabled;
+        break;
+    case TOGGLE_LOW_BATTERY_INDICATION:
+        app_state->should_enable_low_battery_indication = !app_state->should_enable_low_battery_indication;
+        app_state->should_save_settings = true;
+        break;
+    case UNINSTALL:
+        if (app_state->is_dry_run)
+        {
+            printf("Dry run, skipping uninstall\n");
+        }
+        else
+        {
+            uninstall_daemon();
+        }
+        app_state->should_install_daemon = false;
+        app_state->should_quit = true;
+        break;
+    case QUIT:
+        app_state->should_quit = true;
+        break;
+    default:
+        break;
+    }
+}
+
+int initialize_app_state(AppState *app_state)
+{
+    /* Begin with first LED selected. */
+    app_state->selected_led = LED_FRONT;
+    app_state->selected_setting = BRIGHTNESS;
+    app_state->should_save_settings = false;
+    app_state->settings_changed_millis = 0;
+    app_state->should_quit = false;
+    app_state->should_install_daemon = true;
+    app_state->are_extended_colors_enabled = false;
+    app_state->should_enable_low_battery_indication = true;
+    app_state->is_dry_run = false;
+    app_state->hue_sweep.is_active = false;
+    app_state->renderer_name[0] = '\0';
+    app_state->current_page = CONFIG_PAGE;
+    app_state->selected_menu_option = ENABLE_ALL;
+
+    /* Load LED settings from file. */
+    if (read_settings(app_state) != 0)
+    {
+        printf("Failed to read settings\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* The [global] keys, they follow every schema key alphabetically. */
+#define RENDERER_KEY "renderer"
+#define LOW_BATTERY_INDICATION_KEY "should_enable_low_battery_indication"
+
+typedef struct
+{
+    const char *name;
+    size_t name_length;
+    /* LED_FIELD_COUNT for the [global] keys */
+    LedSettingField field;
+    /* 0 for text values */
+    int base;
+} SettingKeyInfo;
+
+#define LED_SETTINGS_KEY_INFO(type, field, FIELD_ID, option, key, minimum, maximum, step, base, ...) {key, sizeof(key) - 1, FIELD_ID, base},
+
+/* Sorted by name, looked up with a binary search. */
+static const SettingKeyInfo setting_keys[] = {
+    LED_SETTINGS_SCHEMA(LED_SETTINGS_KEY_INFO)
+    {RENDERER_KEY, sizeof(RENDERER_KEY) - 1, LED_FIELD_COUNT, 0},
+    {LOW_BATTERY_INDICATION_KEY, sizeof(LOW_BATTERY_INDICATION_KEY) - 1, LED_FIELD_COUNT, 10},
+};
+
+/* Section index for [global], LED sections use their Led value and unknown sections -1. */
+#define SETTINGS_SECTION_GLOBAL -2
+
+static const SettingKeyInfo *find_setting_key(const char *name, size_t name_length)
+{
+    int low = 0;
+    int high = (int)(sizeof(setting_keys) / sizeof(setting_keys[0])) - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        const SettingKeyInfo *info = &setting_keys[middle];
+        size_t shorter_length = name_length < info->name_length ? name_length : info->name_length;
+        int order = memcmp(name, info->name, shorter_length);
+        if (order == 0)
+        {
+            order = (name_length > info->name_length) - (name_length < info->name_length);
+        }
+
+        if (order == 0)
+        {
+            return info;
+        }
+        else if (order < 0)
+        {
+            high = middle - 1;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return NULL;
+}
+
+/* Bounded replacement for the strtol family, the buffer isn't NUL terminated.
+ * Saturates instead of overflowing so clamp always sees an in-range int. */
+static bool parse_setting_value(const char *cursor, const char *line_end, int base, int *value)
+{
+    while (cursor < line_end && (*cursor == ' ' || *cursor == '\t'))
+    {
+        cursor++;
+    }
+
+    bool is_negative = false;
+    if (cursor < line_end && (*cursor == '-' || *cursor == '+'))
+    {
+        is_negative = *cursor == '-';
+        cursor++;
+    }
+
+    if (base == 16 && line_end - cursor > 2 && cursor[0] == '0' && (cursor[1] == 'x' || cursor[1] == 'X'))
+    {
+        cursor += 2;
+    }
+
+    long magnitude = 0;
+    bool has_digits = false;
+    for (; cursor < line_end; cursor++)
+    {
+        int digit;
+        if (*cursor >= '0' && *cursor <= '9')
+        {
+            digit = *cursor - '0';
+        }
+        else if (base == 16 && *cursor >= 'a' && *cursor <= 'f')
+        {
+            digit = *cursor - 'a' + 10;
+        }
+        else if (base == 16 && *cursor >= 'A' && *cursor <= 'F')
+        {
+            digit = *cursor - 'A' + 10;
+        }
+        else
+        {
+            break;
+        }
+        has_digits = true;
+        magnitude = magnitude * base + digit;
+        if (magnitude > INT32_MAX)
+        {
+            magnitude = INT32_MAX;
+        }
+    }
+
+    if (has_digits)
+    {
+        *value = is_negative ? -(int)magnitude : (int)magnitude;
+    }
+    return has_digits;
+}
+
+LedSettingField led_setting_field_for_key(const char *key)
+{
+    const SettingKeyInfo *info = find_setting_key(key, strlen(key));
+    return info != NULL ? info->field : LED_FIELD_COUNT;
+}
+
+bool parse_led_setting_value(LedSettingField field, const char *text, int *value)
+{
+    return parse_setting_value(text, text + strlen(text), led_setting_descriptors[field].base, value);
+}
+
+/* Copies a render driver name, only letters, digits and underscores so it can never break the file. */
+static bool parse_renderer_name(const char *cursor, const char *line_end, char *renderer_name)
+{
+    size_t length = 0;
+    for (; cursor < line_end && length < RENDERER_NAME_LENGTH - 1; cursor++)
+    {
+        char character = *cursor;
+        if (!((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') ||
+              character == '_'))
+        {
+            break;
+        }
+        renderer_name[length++] = character;
+    }
+    renderer_name[length] = '\0';
+    return length > 0;
+}
+
+static void clamp_led_settings(AppState *app_state, Led led)
+{
+    for (LedSettingField field = 0; field < LED_FIELD_COUNT; field++)
+    {
+        set_led_setting(app_state, led, field, get_led_setting(&app_state->led_settings[led], field));
+    }
+}
+
+int parse_settings_buffer(const char *buffer, size_t length, AppState *app_state)
+{
+    const char *buffer_end = buffer + length;
+    const char *line_start = buffer;
+    int section = -1;
+    int applied_count = 0;
+
+    while (line_start < buffer_end)
+    {
+        const char *line_end = memchr(line_start, '\n', buffer_end - line_start);
+        const char *next_line = line_end ? line_end + 1 : buffer_end;
+        if (!line_end)
+        {
+            line_end = buffer_end;
+        }
+        if (line_end > line_start && line_end[-1] == '\r')
+        {
+            line_end--;
+        }
+
+        if (line_start < line_end && *line_start == '[')
+        {
+            const char *name_start = line_start + 1;
+            const char *name_end = memchr(name_start, ']', line_end - name_start);
+            size_t name_length = (name_end ? name_end : line_end) - name_start;
+            char section_name[STRING_LENGTH];
+            if (name_end == name_start)
+            {
+                /* "[]" isn't a section header, and can't be a key either. */
+            }
+            else if (name_length == 0 || name_length >= sizeof(section_name))
+            {
+                section = -1;
+            }
+            else
+            {
+                memcpy(section_name, name_start, name_length);
+                section_name[name_length] = '\0';
+                section = strcmp(section_name, "global") == 0 ? SETTINGS_SECTION_GLOBAL : (int)internal_led_name_to_led(section_name);
+                if (section >= 0 && section < LED_COUNT)
+                {
+                    /* Keys missing from the file still have to end up in range. */
+                    clamp_led_settings(app_state, section);
+                }
+            }
+            line_start = next_line;
+            continue;
+        }
+
+        const char *separator = memchr(line_start, '=', line_end - line_start);
+        const SettingKeyInfo *info = separator ? find_setting_key(line_start, separator - line_start) : NULL;
+        int value;
+        /* Keys are only applied inside their own section type, [global] or an LED. */
+        bool is_global_key = info && info->field == LED_FIELD_COUNT;
+        if (info && info->base == 0)
+        {
+            if (section == SETTINGS_SECTION_GLOBAL && parse_renderer_name(separator + 1, line_end, app_state->renderer_name))
+            {
+                applied_count++;
+            }
+        }
+        else if (info && is_global_key == (section == SETTINGS_SECTION_GLOBAL) &&
+                 (is_global_key || (section >= 0 && section < LED_COUNT)) &&
+                 parse_setting_value(separator + 1, line_end, info->base, &value))
+        {
+            if (is_global_key)
+            {
+                app_state->should_enable_low_battery_indication = value != 0;
+            }
+            else
+            {
+                set_led_setting(app_state, section, info->field, value);
+            }
+            applied_count++;
+        }
+        line_start = next_line;
+    }
+    return applied_count;
+}
+
+uint64_t content_hash(uint64_t hash, const void *bytes, size_t length)
+{
+    const unsigned char *cursor = bytes;
+    for (size_t index = 0; index < length; index++)
+    {
+        hash ^= cursor[index];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_settings_text(const char *text, size_t length)
+{
+    return content_hash(CONTENT_HASH_SEED, text, length);
+}
+
+int read_settings(AppState *app_state)
+{
+    trace_begin("read_settings");
+    int file_descriptor = open(settings_file_path, O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        perror("open");
+        printf("Failed to open %s for reading\n", settings_file_path);
+        trace_end("read_settings");
+        return 1;
+    }
+
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0)
+    {
+        perror("fstat");
+        close(file_descriptor);
+        trace_end("read_settings");
+        return 1;
+    }
+
+    printf("Reading settings from %s ...\n", settings_file_path);
+
+    /* mmap can't map an empty file, there's nothing to apply either way. */
+    if (file_status.st_size > 0)
+    {
+        const char *contents = mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (contents == MAP_FAILED)
+        {
+            perror("mmap");
+            close(file_descriptor);
+            trace_end("read_settings");
+            return 1;
+        }
+        parse_settings_buffer(contents, file_status.st_size, app_state);
+        persisted_settings_hash = hash_settings_text(contents, file_status.st_size);
+        has_persisted_settings_hash = true;
+        munmap((void *)contents, file_status.st_size);
+    }
+    printf("Settings read successfully\n");
+
+    close(file_descriptor);
+    trace_end("read_settings");
+    return 0;
+}
+
+void sync_parent_directory(const char *path)
+{
+    char directory_path[STRING_LENGTH * 2];
+    const char *last_slash = strrchr(path, '/');
+    if (last_slash)
+    {
+        snprintf(directory_path, sizeof(directory_path), "%.*s", (int)(last_slash - path + 1), path);
+    }
+    else
+    {
+        snprintf(directory_path, sizeof(directory_path), ".");
+    }
+    int directory_descriptor = open(directory_path, O_RDONLY);
+    if (directory_descriptor >= 0)
+    {
+        fsync(directory_descriptor);
+        close(directory_descriptor);
+    }
+}
+
+int write_file_atomically(const char *path, const char *contents, size_t length)
+{
+    char temp_path[STRING_LENGTH * 2];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    int file_descriptor = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (file_descriptor < 0)
+    {
+        perror("open");
+        printf("Failed to open %s for writing\n", temp_path);
+        return 1;
+    }
+
+    size_t written = 0;
+    while (written < length)
+    {
+        ssize_t result = write(file_descriptor, contents + written, length - written);
+        if (result < 0)
+        {
+            perror("write");
+            close(file_descriptor);
+            unlink(temp_path);
+            return 1;
+        }
+        written += result;
+    }
+
+    /* Close even when fsync fails, and report whichever call actually failed. */
+    bool is_synced = fsync(file_descriptor) == 0;
+    if (!is_synced)
+    {
+        perror("fsync");
+    }
+    bool is_closed = close(file_descriptor) == 0;
+    if (!is_closed)
+    {
+        perror("close");
+    }
+    if (!is_synced || !is_closed)
+    {
+        unlink(temp_path);
+        return 1;
+    }
+
+    if (rename(temp_path, path) != 0)
+    {
+        perror("rename");
+        unlink(temp_path);
+        return 1;
+    }
+
+    /* Persist the rename itself by syncing the directory entry. */
+    sync_parent_directory(path);
+    return 0;
+}
+
+int save_settings(AppState *app_state)
+{
+    trace_begin("save_settings");
+    app_state->should_save_settings = false;
+
+    char contents[SETTINGS_TEXT_CAPACITY];
+    size_t length = 0;
+
+    // Save global settings first
+    length += snprintf(contents + length, sizeof(contents) - length, "[global]\n");
+    if (app_state->renderer_name[0] != '\0')
+    {
+        length += snprintf(contents + length, sizeof(contents) - length, "%s=%s\n", RENDERER_KEY, app_state->renderer_name);
+    }
+    length += snprintf(contents + length, sizeof(contents) - length, "%s=%d\n\n", LOW_BATTERY_INDICATION_KEY, app_state->should_enable_low_battery_indication);
+
+    // Save LED-specific settings
+    for (Led led = 0; led < LED_COUNT && length < sizeof(contents); led++)
+    {
+        length += snprintf(contents + length, sizeof(contents) - length, "[%s]\n", led_internal_name(led));
+        for (LedSettingField field = 0; field < LED_FIELD_COUNT && length < sizeof(contents); field++)
+        {
+            const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+            length += snprintf(contents + length, sizeof(contents) - length, "%s=", descriptor->key);
+            if (length < sizeof(contents))
+            {
+                length += snprintf(contents + length, sizeof(contents) - length, descriptor->ini_format,
+                                   get_led_setting(&app_state->led_settings[led], field));
+            }
+            if (length < sizeof(contents))
+            {
+                contents[length++] = '\n';
+            }
+        }
+        if (length < sizeof(contents))
+        {
+            contents[length++] = '\n';
+        }
+    }
+    if (length >= sizeof(contents))
+    {
+        printf("Settings don't fit in %d bytes, not saving\n", SETTINGS_TEXT_CAPACITY);
+        trace_end("save_settings");
+        return 1;
+    }
+
+    /* Skip the SD card entirely when nothing changed since the last read or write. */
+    uint64_t contents_hash = hash_settings_text(contents, length);
+    if (has_persisted_settings_hash && contents_hash == persisted_settings_hash)
+    {
+        trace_end("save_settings");
+        return 0;
+    }
+
+    printf("Saving settings to %s ...\n", settings_file_path);
+    if (write_file_atomically(settings_file_path, contents, length) != 0)
+    {
+        printf("Failed to save settings to %s\n", settings_file_path);
+        trace_end("save_settings");
+        return 1;
+    }
+    persisted_settings_hash = contents_hash;
+    has_persisted_settings_hash = true;
+    printf("Settings saved successfully\n");
+
+    trace_end("save_settings");
+    return 0;
+}
+
+void request_settings_save(AppState *app_state, uint32_t now_millis)
+{
+    app_state->should_save_settings = true;
+    app_state->settings_changed_millis = now_millis;
+}
+
+int save_settings_if_idle(AppState *app_state, uint32_t now_millis)
+{
+    /* Unsigned subtraction keeps working when the millisecond clock wraps. */
+    if (!app_state->should_save_settings || now_millis - app_state->settings_changed_millis < SETTINGS_SAVE_DEBOUNCE_MILLIS)
+    {
+        return 0;
+    }
+    return save_settings(app_state);
+}
+
+void write_led_setting_sys_file(const AppState *app_state, Led led, LedSettingField field)
+{
+    const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+    const char *led_suffix[1] = {led_internal_name(led)};
+    bool is_split = led == LED_FRONT && descriptor->splits_front_led;
+    const char **suffix_array = is_split ? front_led_suffix : led_suffix;
+    int value = get_led_setting(&app_state->led_settings[led], field);
+    char filepath[STRING_LENGTH];
+
+    for (int suffix_index = 0; suffix_index < (is_split ? 2 : 1); suffix_index++)
+    {
+        /* Why are you like this TrimUI? The top LED's brightness file has no suffix. */
+        if (led == LED_TOP && field == LED_FIELD_BRIGHTNESS)
+        {
+            snprintf(filepath, sizeof(filepath), "%s/%s", led_sys_file_path, descriptor->sysfs_attribute);
+        }
+        else
+        {
+            snprintf(filepath, sizeof(filepath), "%s/%s_%s", led_sys_file_path, descriptor->sysfs_attribute, suffix_array[suffix_index]);
+        }
+
+        FILE *file = fopen(filepath, "w");
+        if (file != NULL)
+        {
+            fprintf(file, descriptor->sysfs_format, value);
+            led_sys_file_write_count++;
+            fclose(file);
+        }
+        else
+        {
+            printf("Failed to open file: %s\n", filepath);
+        }
+    }
+}
+
+void update_leds(AppState *app_state)
+{
+    trace_begin("update_leds");
+    app_state->should_update_leds = false;
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        for (LedSettingField field = 0; field < LED_FIELD_COUNT; field++)
+        {
+            write_led_setting_sys_file(app_state, led, field);
+        }
+        app_state->dirty_led_fields[led] = 0;
+    }
+    trace_end("update_leds");
+}
+
+void commit_dirty_leds(AppState *app_state)
+{
+    trace_begin("commit_dirty_leds");
+    app_state->should_update_leds = false;
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        for (LedSettingField field = 0; field < LED_FIELD_COUNT; field++)
+        {
+            if (app_state->dirty_led_fields[led] & (1u << field))
+            {
+                write_led_setting_sys_file(app_state, led, field);
+            }
+        }
+        app_state->dirty_led_fields[led] = 0;
+    }
+    trace_end("commit_dirty_leds");
+}
+
+int persist_settings_detached(AppState *app_state)
+{
+    /* A worker's spans would never reach trace_write, traced runs persist inline so they show up. */
+    pid_t worker = -1;
+    if (!trace_is_enabled())
+    {
+        /* Anything still buffered would otherwise be written by both processes. */
+        fflush(stdout);
+        fflush(stderr);
+        worker = fork();
+        if (worker > 0)
+        {
+            return 0;
+        }
+        else if (worker < 0)
+        {
+            perror("fork");
+        }
+    }
+
+    if (worker == 0)
+    {
+        /* Outlive the launcher's session, the parent never waits for us. */
+        setsid();
+    }
+
+    int result = save_settings(app_state);
+    if (app_state->should_install_daemon && install_daemon(app_state->should_enable_low_battery_indication) != 0)
+    {
+        result = 1;
+    }
+
+    if (worker == 0)
+    {
+        fflush(stdout);
+        _exit(result);
+    }
+    return result;
+}
+
+void color_match_leds(AppState *app_state)
+{
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        set_led_setting(app_state, led, LED_FIELD_COLOR, app_state->led_settings[app_state->selected_led].color);
+    }
+}
+
+/* Brightness file of every LED, and the effect files the firmware watches for changes, relative to led_sys_file_path. */
+static const char *const led_brightness_file_names[] = {"max_scale", "max_scale_f1f2", "max_scale_lr"};
+static const char *const led_effect_file_names[] = {"effect_lr", "effect_m", "effect_f1", "effect_f2"};
+
+static int write_led_sys_files(const char *const *file_names, size_t file_count, int value)
+{
+    char filepath[STRING_LENGTH];
+    int result = 0;
+    for (size_t file_index = 0; file_index < file_count; file_index++)
+    {
+        snprintf(filepath, sizeof(filepath), "%s/%s", led_sys_file_path, file_names[file_index]);
+        FILE *file = fopen(filepath, "w");
+        if (file == NULL)
+        {
+            perror("fopen");
+            printf("Failed to open file: %s\n", filepath);
+            result = 1;
+            continue;
+        }
+        fprintf(file, "%d\n", value);
+        led_sys_file_write_count++;
+        fclose(file);
+    }
+    return result;
+}
+
+int write_all_leds_power(bool is_on)
+{
+    int result = write_led_sys_files(led_brightness_file_names, sizeof(led_brightness_file_names) / sizeof(led_brightness_file_names[0]),
+                                     is_on ? MAX_BRIGHTNESS : 0);
+    if (!is_on)
+    {
+        /* Written last, a changed effect file is what makes the firmware apply the new brightness. */
+        result |= write_led_sys_files(led_effect_file_names, sizeof(led_effect_file_names) / sizeof(led_effect_file_names[0]), DISABLE);
+    }
+    return result;
+}
+
+void turn_off_all_leds(AppState *app_state)
+{
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        set_led_setting(app_state, led, LED_FIELD_BRIGHTNESS, 0);
+        set_led_setting(app_state, led, LED_FIELD_EFFECT, DISABLE);
+    }
+    update_leds(app_state);
+    write_all_leds_power(false);
+}
+
+void turn_on_all_leds(AppState *app_state)
+{
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        set_led_setting(app_state, led, LED_FIELD_BRIGHTNESS, MAX_BRIGHTNESS);
+        set_led_setting(app_state, led, LED_FIELD_EFFECT, STATIC);
+    }
+    update_leds(app_state);
+    write_all_leds_power(true);
+}
+
+int set_led_sys_files_writable(bool writable)
+{
+    DIR *directory = opendir(led_sys_file_path);
+    if (!directory)
+    {
+        perror("opendir");
+        printf("Failed to open %s\n", led_sys_file_path);
+        return 1;
+    }
+
+    /* Room for the directory plus a full directory entry name. */
+    char filepath[STRING_LENGTH * 2];
+    struct stat file_status;
+    struct dirent *entry;
+    int result = 0;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        snprintf(filepath, sizeof(filepath), "%s/%s", led_sys_file_path, entry->d_name);
+        if (stat(filepath, &file_status) != 0 || !S_ISREG(file_status.st_mode))
+        {
+            continue;
+        }
+
+        /* Same as chmod a+w / a-w, other permission bits are left alone. */
+        mode_t write_bits = S_IWUSR | S_IWGRP | S_IWOTH;
+        mode_t mode = writable ? (file_status.st_mode | write_bits) : (file_status.st_mode & ~write_bits);
+        if (chmod(filepath, mode & 07777) != 0)
+        {
+            perror("chmod");
+            result = 1;
+        }
+    }
+    closedir(directory);
+    return result;
+}
@@ -0,0 +1,65 @@
+#include "led_effect.h"
+#include <stdbool.h>
+
+/* Intensity over one period for every effect, filled on first use. */
+static uint8_t led_effect_tables[ANIMATION_EFFECT_COUNT][LED_EFFECT_TABLE_SIZE];
+static bool are_led_effect_tables_built = false;
+
+/* Sample the curves once, integer only so libledcore users don't need libm. */
+static void build_led_effect_tables(void)
+{
+    for (int sample = 0; sample < LED_EFFECT_TABLE_SIZE; sample++)
+    {
+        /* 0 -> 255 -> 0 over the period */
+        int ramp = sample < LED_EFFECT_TABLE_SIZE / 2 ? sample * 255 / 127 : (LED_EFFECT_TABLE_SIZE - 1 - sample) * 255 / 127;
+        /* Sniff rises over the first eighth of the period and fades quadratically over the rest */
+        int sniff_rise = LED_EFFECT_TABLE_SIZE / 8;
+        int sniff_left = LED_EFFECT_TABLE_SIZE - 1 - sample;
+        int sniff_fall = LED_EFFECT_TABLE_SIZE - 1 - sniff_rise;
+
+        led_effect_tables[DISABLE][sample] = 0;
+        led_effect_tables[STATIC][sample] = 255;
+        led_effect_tables[LINEAR][sample] = (uint8_t)ramp;
+        /* Smoothstep of the ramp, 3x^2 - 2x^3 */
+        led_effect_tables[BREATH][sample] = (uint8_t)((3 * ramp * ramp * 255 - 2 * ramp * ramp * ramp) / (255 * 255));
+        led_effect_tables[SNIFF][sample] = (uint8_t)(sample < sniff_rise ? sample * 255 / sniff_rise : 255 * sniff_left * sniff_left / (sniff_fall * sniff_fall));
+
+        /* BLINKn splits the period into 2n + 2 slots, flashes in the even slots and stays dark for the last two. */
+        for (int blink_count = 1; blink_count <= 3; blink_count++)
+        {
+            int slot = sample * (2 * blink_count + 2) / LED_EFFECT_TABLE_SIZE;
+            led_effect_tables[BLINK1 + blink_count - 1][sample] = slot < 2 * blink_count && slot % 2 == 0 ? 255 : 0;
+        }
+    }
+    are_led_effect_tables_built = true;
+}
+
+uint8_t led_effect_intensity(AnimationEffect effect, int duration_millis, uint32_t elapsed_millis)
+{
+    if (effect < 0 || effect >= ANIMATION_EFFECT_COUNT || effect == DISABLE)
+    {
+        return 0;
+    }
+    if (duration_millis <= 0)
+    {
+        return 255;
+    }
+    if (!are_led_effect_tables_built)
+    {
+        build_led_effect_tables();
+    }
+    uint32_t sample = (uint32_t)((uint64_t)(elapsed_millis % (uint32_t)duration_millis) * LED_EFFECT_TABLE_SIZE / (uint32_t)duration_millis);
+    return led_effect_tables[effect][sample];
+}
+
+uint32_t led_effect_color(const LedSettings *settings, uint32_t elapsed_millis)
+{
+    uint32_t scale = (uint32_t)led_effect_intensity(settings->effect, settings->duration, elapsed_millis) * (uint32_t)settings->brightness;
+    uint32_t color = 0;
+    for (int shift = 0; shift <= 16; shift += 8)
+    {
+        uint32_t channel = (settings->color >> shift) & 0xFF;
+        color |= (channel * scale / (255 * MAX_BRIGHTNESS)) << shift;
+    }
+    return color;
+}
@@ -0,0 +1,51 @@
+#include "led_core.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Boot time settings applier.
+ *
+ * Runs once at boot from /etc/init.d/led-settings-daemon, reads the installed
+ * settings file and commits it to the LED system files. Links only libledcore
+ * so boot doesn't pay for loading SDL.
+ */
+
+#define DAEMON_NAME "led_settings_daemon"
+
+int main(int argc, char *argv[])
+{
+    /* Boot runs outside the pak directory, default to the copy install_daemon made. */
+    settings_file_path = INSTALLED_SETTINGS_FILE;
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        const char *argument = argv[arg_index];
+        if (strncmp(argument, "--settings=", strlen("--settings=")) == 0)
+        {
+            settings_file_path = argument + strlen("--settings=");
+        }
+        else if (strncmp(argument, "--sys-root=", strlen("--sys-root=")) == 0)
+        {
+            led_sys_file_path = argument + strlen("--sys-root=");
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--settings=path] [--sys-root=dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("[%s]: LED settings daemon started ...\n", DAEMON_NAME);
+    AppState app_state = {0};
+    if (read_settings(&app_state) != 0)
+    {
+        printf("[%s]: No settings to apply, exiting ...\n", DAEMON_NAME);
+        return 1;
+    }
+
+    printf("[%s]: Writing LED information to configuration files ...\n", DAEMON_NAME);
+    set_led_sys_files_writable(true);
+    update_leds(&app_state);
+    set_led_sys_files_writable(false);
+
+    printf("[%s]: Wrote %lu LED files, exiting ...\n", DAEMON_NAME, led_sys_file_write_count);
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "installer.h"
+#include "led_core.h"
+#include "led_effect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Command line front end to libledcore for scripting and SSH sessions.
+ *
+ *  ledctl [--settings=path] [--sys-root=dir] show
+ *  ledctl [--settings=path] [--sys-root=dir] apply
+ *  ledctl [--settings=path] [--sys-root=dir] set <front|top|back|all> <setting> <value>
+ *  ledctl [--settings=path] [--sys-root=dir] install|uninstall
+ *  ledctl [--settings=path] simulate <front|top|back> [millis] [step_millis]
+ */
+
+static int print_usage(const char *program_name)
+{
+    fprintf(stderr, "Usage: %s [--settings=path] [--sys-root=dir] show\n", program_name);
+    fprintf(stderr, "       %s [--settings=path] [--sys-root=dir] apply\n", program_name);
+    fprintf(stderr, "       %s [--settings=path] [--sys-root=dir] set <front|top|back|all> <setting> <value>\n", program_name);
+    fprintf(stderr, "       %s [--settings=path] [--sys-root=dir] install|uninstall\n", program_name);
+    fprintf(stderr, "       %s [--settings=path] simulate <front|top|back> [millis] [step_millis]\n", program_name);
+    fprintf(stderr, "Settings:");
+    for (LedSettingField field = 0; field < LED_FIELD_COUNT; field++)
+    {
+        const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+        char minimum[16];
+        char maximum[16];
+        snprintf(minimum, sizeof(minimum), descriptor->ini_format, descriptor->minimum);
+        snprintf(maximum, sizeof(maximum), descriptor->ini_format, descriptor->maximum);
+        fprintf(stderr, " %s (%s-%s)", descriptor->key, minimum, maximum);
+    }
+    fprintf(stderr, "\n");
+    return 1;
+}
+
+static void show_settings(const AppState *app_state)
+{
+    for (Led led = 0; led < LED_COUNT; led++)
+    {
+        printf("%-5s", led_internal_name(led));
+        for (LedSettingField field = 0; field < LED_FIELD_COUNT; field++)
+        {
+            /* Raw value as set takes it, then the value as the config page shows it. */
+            const LedSettingDescriptor *descriptor = &led_setting_descriptors[field];
+            int value = get_led_setting(&app_state->led_settings[led], field);
+            char raw_value[16];
+            char shown_value[32];
+            snprintf(raw_value, sizeof(raw_value), descriptor->ini_format, value);
+            descriptor->format_value(value, shown_value, sizeof(shown_value));
+            printf(" %s=%s (%s)", descriptor->key, raw_value, shown_value);
+        }
+        printf("\n");
+    }
+    printf("low_battery_indication=%d\n", app_state->should_enable_low_battery_indication);
+}
+
+/* Print the color the LED would show every step_millis, one period of its effect by default. */
+static void simulate_led(const LedSettings *settings, int millis, int step_millis)
+{
+    if (millis <= 0)
+    {
+        millis = settings->duration > 0 ? settings->duration : 1;
+    }
+    if (step_millis <= 0)
+    {
+        step_millis = millis / 16 > 0 ? millis / 16 : 1;
+    }
+    for (int elapsed = 0; elapsed <= millis; elapsed += step_millis)
+    {
+        printf("%6d ms intensity=%3d color=0x%06X\n", elapsed, led_effect_intensity(settings->effect, settings->duration, elapsed),
+               led_effect_color(settings, elapsed));
+    }
+}
+
+/* Accepts the user facing names as well as the internal f1f2/m/lr names. */
+static int parse_led_name(const char *led_name)
+{
+    if (strcmp(led_name, "front") == 0)
+    {
+        return LED_FRONT;
+    }
+    else if (strcmp(led_name, "top") == 0)
+    {
+        return LED_TOP;
+    }
+    else if (strcmp(led_name, "back") == 0)
+    {
+        return LED_BACK;
+    }
+    return internal_led_name_to_led(led_name);
+}
+
+int main(int argc, char *argv[])
+{
+    int arg_index = 1;
+    for (; arg_index < argc && strncmp(argv[arg_index], "--", 2) == 0; arg_index++)
+    {
+        if (strncmp(argv[arg_index], "--settings=", strlen("--settings=")) == 0)
+        {
+            settings_file_path = argv[arg_index] + strlen("--settings=");
+        }
+        else if (strncmp(argv[arg_index], "--sys-root=", strlen("--sys-root=")) == 0)
+        {
+            led_sys_file_path = argv[arg_index] + strlen("--sys-root=");
+        }
+        else
+        {
+            return print_usage(argv[0]);
+        }
+    }
+    if (arg_index >= argc)
+    {
+        return print_usage(argv[0]);
+    }
+
+    const char *command = argv[arg_index];
+    AppState app_state = {0};
+    app_state.should_enable_low_battery_indication = true;
+    if (read_settings(&app_state) != 0)
+    {
+        return 1;
+    }
+
+    if (strcmp(command, "show") == 0)
+    {
+        show_settings(&app_state);
+        return 0;
+    }
+    else if (strcmp(command, "apply") == 0)
+    {
+        update_leds(&app_state);
+        return 0;
+    }
+    else if (strcmp(command, "install") == 0)
+    {
+        /* Sources are pak relative, run this from the pak directory. */
+        return install_daemon(app_state.should_enable_low_battery_indication);
+    }
+    else if (strcmp(command, "uninstall") == 0)
+    {
+        return uninstall_daemon();
+    }
+    else if (strcmp(command, "simulate") == 0 && argc - arg_index >= 2 && argc - arg_index <= 4)
+    {
+        int led = parse_led_name(argv[arg_index + 1]);
+        if (led < 0)
+        {
+            fprintf(stderr, "Unknown LED: %s\n", argv[arg_index + 1]);
+            return 1;
+        }
+        simulate_led(&app_state.led_settings[led], argc - arg_index >= 3 ? atoi(argv[arg_index + 2]) : 0,
+                     argc - arg_index >= 4 ? atoi(argv[arg_index + 3]) : 0);
+        return 0;
+    }
+    else if (strcmp(command, "set") == 0 && argc - arg_index == 4)
+    {
+        const char *led_name = argv[arg_index + 1];
+        int first_led = 0;
+        int last_led = LED_COUNT - 1;
+        if (strcmp(led_name, "all") != 0)
+        {
+            first_led = last_led = parse_led_name(led_name);
+            if (first_led < 0)
+            {
+                fprintf(stderr, "Unknown LED: %s\n", led_name);
+                return 1;
+            }
+        }
+
+        /* Same lookup, parsing and bounds as the settings file, out of range values are clamped. */
+        const char *setting_name = argv[arg_index + 2];
+        LedSettingField field = led_setting_field_for_key(setting_name);
+        if (field == LED_FIELD_COUNT)
+        {
+            fprintf(stderr, "Unknown setting: %s\n", setting_name);
+            return 1;
+        }
+        int value;
+        if (!parse_led_setting_value(field, argv[arg_index + 3], &value))
+        {
+            fprintf(stderr, "Invalid %s value: %s\n", setting_name, argv[arg_index + 3]);
+            return 1;
+        }
+
+        for (int target = first_led; target <= last_led; target++)
+        {
+            set_led_setting(&app_state, target, field, value);
+        }
+
+        if (save_settings(&app_state) != 0)
+        {
+            return 1;
+        }
+        commit_dirty_leds(&app_state);
+        return 0;
+    }
+    return print_usage(argv[0]);
+}
@@ -0,0 +1,266 @@
+#include "led_controller.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+int main(int argc, char *argv[])
+{
+    /* Swaps SDL's allocator, so it has to come before anything else touches SDL. */
+    install_allocation_counter();
+
+    /* Handle program inputs */
+    ProgramOptions options;
+    parse_program_options(argc, argv, &options);
+    bool verbose_logging_enabled = options.verbose_logging_enabled;
+
+    /* Start tracing before anything we want to see in the timeline. */
+    if (options.trace_output_path != NULL)
+    {
+        trace_initialize(options.trace_output_path);
+    }
+
+    /* Core SDL components that every application (I write) requires. */
+    CoreSDLComponents core_components;
+
+    /* SDL components that this application (I write) requires beyond the core components. */
+    AdditionalSDLComponents components;
+
+    /* User state object, contains all relevant user selection information. */
+    AppState app_state;
+
+    /* The collection of user interface related objects. */
+    SelectableMenuItems config_page_ui;
+
+    /* The collection of user interface related objects. */
+    SelectableMenuItems menu_page_ui;
+
+    Sprite brick_sprite;
+    /* The last user input converted from SDL_Event. */
+    InputType user_input;
+
+    /* SDL event object we read on loop. */
+    SDL_Event event;
+
+    /* Inputs replayed from a recording or script on top of live input. */
+    static RecordedInput replay_inputs[REPLAY_INPUT_CAPACITY];
+    InputPlayback playback = {replay_inputs, 0, 0};
+    bool is_replaying = options.replay_path != NULL || options.input_script_path != NULL;
+
+    /* Optional binary log of every input this session. */
+    InputRecorder recorder = {NULL, 0, 0};
+
+    /* Held D-pad and shoulder buttons keep stepping values. */
+    ButtonRepeat button_repeat;
+    button_repeat_init(&button_repeat, (Uint32)options.repeat_delay_millis, options.repeat_acceleration_percent);
+
+    /* The left stick sweeps the selected setting, i.e the hue or brightness. */
+    AnalogStick analog_stick;
+    analog_stick_init(&analog_stick, ANALOG_STICK_DEADZONE);
+
+    /* Initialize onscreen logging message */
+
+    /* Point the LED writers at a fake sysfs tree for benchmarks and replays, they never drive the real LEDs. */
+    if (options.sys_file_root != NULL)
+    {
+        led_sys_file_path = options.sys_file_root;
+    }
+    else if ((is_replaying || options.headless) && use_scratch_sys_root() != 0)
+    {
+        trace_write();
+        return 1;
+    }
+
+    /* Take over from launch.sh before anything is loaded relative to the pak directory. */
+    if (options.launch)
+    {
+        launcher_start(argv[0]);
+    }
+
+    if (options.replay_path != NULL)
+    {
+        playback.input_count = load_input_recording(options.replay_path, replay_inputs, REPLAY_INPUT_CAPACITY);
+    }
+    else if (options.input_script_path != NULL)
+    {
+        playback.input_count = load_input_script(options.input_script_path, replay_inputs, REPLAY_INPUT_CAPACITY);
+    }
+    else if (options.soak_input_count > 0)
+    {
+        playback.input_count = generate_soak_inputs(replay_inputs, REPLAY_INPUT_CAPACITY, options.soak_input_count);
+    }
+    if (playback.input_count < 0)
+    {
+        trace_write();
+        return 1;
+    }
+
+    /* Initialize Primary SDL components */
+    core_components.window_width = WINDOW_WIDTH;
+    core_components.window_height = WINDOW_HEIGHT;
+    core_components.headless = options.headless;
+    core_components.full_color_textures = options.full_color_textures;
+
+    /* Initialize auxilliary data structures */
+    initialize_app_state(&app_state);
+    /* Recorded and scripted sessions can select Uninstall, it must not touch the real install. */
+    app_state.is_dry_run = is_replaying || options.headless;
+    update_leds(&app_state);
+
+    /* --renderer= wins for this run only, otherwise use the driver cached in settings.ini or probe for one. */
+    bool should_probe_renderer = !options.headless && (options.renderer_name != NULL ? strcmp(options.renderer_name, "auto") == 0
+                                                                                       : app_state.renderer_name[0] == '\0');
+    core_components.should_probe_renderer = should_probe_renderer;
+    core_components.requested_renderer = options.renderer_name;
+    if (options.renderer_name == NULL && app_state.renderer_name[0] != '\0')
+    {
+        core_components.requested_renderer = app_state.renderer_name;
+    }
+    if (initialize_sdl_core(&core_components, WINDOW_TITLE) != 0 ||
+        initialize_additional_sdl_components(&core_components, &components) != 0)
+    {
+        SDL_Log("Failed to initialize SDL, exiting...\n");
+        trace_write();
+        return options.launch ? launcher_finish(1) : 1;
+    }
+    printf("Renderer: %s%s\n", core_components.renderer_name != NULL ? core_components.renderer_name : "unknown",
+           should_probe_renderer ? " (probed)" : "");
+    if (should_probe_renderer && core_components.renderer_name != NULL)
+    {
+        /* Written with the rest of the settings on exit, later launches skip the probe. */
+        snprintf(app_state.renderer_name, sizeof(app_state.renderer_name), "%s", core_components.renderer_name);
+    }
+    initialize_config_page_ui(&config_page_ui, &core_components, &components);
+    initialize_menu_ui(&menu_page_ui, &core_components, &components, &app_state);
+
+    update_config_page_ui_text(&config_page_ui, &core_components, &components, &app_state);
+    update_menu_ui_text(&menu_page_ui, &core_components, &components, &app_state);
+
+    /* Initialize sprites */
+    initialize_brick_sprite(&brick_sprite, components.brickSpriteSheetTexture, &components.brickSpriteAtlas, &components.ui_arena);
+    /* Render the background */
+    SDL_RenderCopy(core_components.renderer, components.backgroundTexture, NULL, NULL);
+
+    /* Benchmark runs only measure rendering, they never persist settings or install the daemon. */
+    if (options.headless)
+    {
+        int headless_result = run_headless_session(&app_state, &core_components, &components, &brick_sprite, &config_page_ui, &menu_page_ui,
+                                                   &playback, &options);
+        teardown(&core_components, &components, &config_page_ui, &menu_page_ui, &brick_sprite, &app_state);
+        trace_write();
+        return headless_result;
+    }
+
+    if (options.record_path != NULL)
+    {
+        input_recorder_open(&recorder, options.record_path, SDL_GetTicks());
+    }
+
+    /* Replays run on their own clock, a fixed step per frame when running at maximum speed. */
+    Uint32 replay_start_millis = SDL_GetTicks();
+    Uint32 replay_clock_millis = 0;
+    Uint64 render_ticks_total = 0;
+    Uint64 render_ticks_max = 0;
+    int frames_rendered = 0;
+
+    while (!app_state.should_quit)
+    {
+        /* Handle events */
+        SDL_PumpEvents();
+        note_event_queue_depth();
+        while (SDL_PollEvent(&event) != 0)
+        {
+            /* Before the filter below, button releases aren't supported input events. */
+            button_repeat_track(&button_repeat, &event, SDL_GetTicks());
+            analog_stick_track(&analog_stick, &event);
+
+            /* Ignore unsupported input events */
+            if (!is_supported_input_event(event.type))
+            {
+                continue;
+            }
+
+            if (event.type == SDL_QUIT)
+            {
+                app_state.should_quit = true;
+                break;
+            }
+            /* Take and process user input. */
+            user_input = sdl_event_to_input_type(&event, false);
+            input_recorder_write(&recorder, user_input, SDL_GetTicks());
+
+            handle_event_updates(&app_state, &core_components, &components, &config_page_ui, &menu_page_ui, user_input, event);
+        }
+        handle_repeated_inputs(&button_repeat, SDL_GetTicks(), &recorder, &app_state, &core_components, &components, &config_page_ui,
+                               &menu_page_ui);
+        handle_analog_stick(&analog_stick, SDL_GetTicks(), &recorder, &app_state, &core_components, &components, &config_page_ui,
+                            &menu_page_ui);
+
+        if (is_replaying)
+        {
+            replay_clock_millis = options.replay_at_max_speed ? replay_clock_millis + REPLAY_FRAME_MILLIS : SDL_GetTicks() - replay_start_millis;
+            handle_replayed_inputs(&playback, replay_clock_millis, &app_state, &core_components, &components, &config_page_ui, &menu_page_ui);
+        }
+
+        /* Replays never touch the user's settings file. */
+        if (!is_replaying)
+        {
+            save_settings_if_idle(&app_state, SDL_GetTicks());
+        }
+
+        /* Call the render_frame function, replays animate on the replay clock */
+        Uint64 render_start = SDL_GetPerformanceCounter();
+        render_frame(&app_state, &core_components, &components, &brick_sprite, &config_page_ui, &menu_page_ui,
+                     is_replaying ? replay_clock_millis : SDL_GetTicks(), verbose_logging_enabled);
+        Uint64 render_ticks = SDL_GetPerformanceCounter() - render_start;
+        if (frames_rendered == 0)
+        {
+            launcher_log("Cold start: first frame presented %u ms after exec", launcher_millis_since_exec());
+        }
+        render_ticks_total += render_ticks;
+        render_ticks_max = render_ticks > render_ticks_max ? render_ticks : render_ticks_max;
+        frames_rendered++;
+
+        /* Delay to control frame rate Approximately 60 frames per second */
+        if (!(is_replaying && options.replay_at_max_speed))
+        {
+            SDL_Delay(16);
+        }
+    }
+
+    if (recorder.file != NULL)
+    {
+        input_recorder_close(&recorder, SDL_GetTicks());
+    }
+
+    /* Replays are benchmarks, they must leave the user's settings and the installed daemon alone. */
+    if (is_replaying)
+    {
+        log_session_counters(frames_rendered, render_ticks_total, render_ticks_max);
+        teardown(&core_components, &components, &config_page_ui, &menu_page_ui, &brick_sprite, &app_state);
+        trace_write();
+        return 0;
+    }
+
+    /* Close the window first, the user shouldn't watch a frozen frame while settings persist. */
+    Uint64 exit_start = SDL_GetPerformanceCounter();
+    Uint64 performance_frequency = SDL_GetPerformanceFrequency();
+    int exit_code = teardown(&core_components, &components, &config_page_ui, &menu_page_ui, &brick_sprite, &app_state);
+    Uint64 window_closed = SDL_GetPerformanceCounter();
+
+    /* LED writes stay inline so --launch can lock the files once they are done. */
+    update_leds(&app_state);
+    persist_settings_detached(&app_state);
+    if (verbose_logging_enabled)
+    {
+        printf("Exit took %.2f ms (window closed after %.2f ms)\n",
+               (double)(SDL_GetPerformanceCounter() - exit_start) * 1000.0 / (double)performance_frequency,
+               (double)(window_closed - exit_start) * 1000.0 / (double)performance_frequency);
+    }
+
+    /* Serialize the trace last so the hot path never pays for I/O. */
+    trace_write();
+    return options.launch ? launcher_finish(exit_code) : exit_code;
+}
@@ -1,8 +1,114 @@
 #include "sdl_base.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Number of textures handed out by the texture creation helpers. */
+static Uint64 textures_created_count = 0;
+/* Number of SDL draw calls made by render_batch_flush. */
+static Uint64 draw_call_count = 0;
+/* Number of events discarded by filter_queued_events before reaching the queue, atomic
+ * because SDL runs the filter on whichever thread pushes the event. */
+static SDL_atomic_t events_dropped_count;
+/* Most events seen waiting in the queue by note_event_queue_depth. */
+static int max_event_queue_depth = 0;
+
+/* A texture or surface counted by track_texture or track_surface. */
+typedef struct
+{
+    const void *resource;
+    const char *site;
+    size_t byte_count;
+    bool is_texture;
+} TrackedResource;
+
+/* Live tracked resources in no particular order, guarded by tracked_resources_lock since
+ * startup assets are decoded on worker threads. */
+static TrackedResource tracked_resources[TRACKED_RESOURCE_CAPACITY];
+static int tracked_resource_count = 0;
+static SDL_SpinLock tracked_resources_lock = 0;
+/* Calls counted by the SDL memory function wrappers, see install_allocation_counter. */
+static SDL_atomic_t allocation_count;
+
+/* Event types below 0x800 as a bitset, types sharing a word are combined in one initializer. */
+#define EVENT_TYPE_BITSET_WORDS 64
+#define EVENT_TYPE_WORD(type) ((type) / 32)
+#define EVENT_TYPE_BIT(type) (1u << ((type) % 32))
+
+/* Events sdl_event_to_input_type turns into inputs. */
+static const Uint32 supported_input_events[EVENT_TYPE_BITSET_WORDS] = {
+    [EVENT_TYPE_WORD(SDL_QUIT)] = EVENT_TYPE_BIT(SDL_QUIT),
+    [EVENT_TYPE_WORD(SDL_KEYDOWN)] = EVENT_TYPE_BIT(SDL_KEYDOWN),
+    [EVENT_TYPE_WORD(SDL_MOUSEBUTTONDOWN)] = EVENT_TYPE_BIT(SDL_MOUSEBUTTONDOWN),
+    [EVENT_TYPE_WORD(SDL_CONTROLLERBUTTONDOWN)] = EVENT_TYPE_BIT(SDL_CONTROLLERBUTTONDOWN),
+};
+
+/* Events allowed into the queue: the supported inputs, what ButtonRepeat and AnalogStick
+ * track, and the joystick events older SDL2 releases build controller events from. */
+static const Uint32 queued_events[EVENT_TYPE_BITSET_WORDS] = {
+    [EVENT_TYPE_WORD(SDL_QUIT)] = EVENT_TYPE_BIT(SDL_QUIT),
+    [EVENT_TYPE_WORD(SDL_KEYDOWN)] = EVENT_TYPE_BIT(SDL_KEYDOWN),
+    [EVENT_TYPE_WORD(SDL_MOUSEBUTTONDOWN)] = EVENT_TYPE_BIT(SDL_MOUSEBUTTONDOWN),
+    [EVENT_TYPE_WORD(SDL_JOYAXISMOTION)] = EVENT_TYPE_BIT(SDL_JOYAXISMOTION) | EVENT_TYPE_BIT(SDL_JOYBALLMOTION) |
+                                           EVENT_TYPE_BIT(SDL_JOYHATMOTION) | EVENT_TYPE_BIT(SDL_JOYBUTTONDOWN) |
+                                           EVENT_TYPE_BIT(SDL_JOYBUTTONUP) | EVENT_TYPE_BIT(SDL_JOYDEVICEADDED) |
+                                           EVENT_TYPE_BIT(SDL_JOYDEVICEREMOVED),
+    [EVENT_TYPE_WORD(SDL_CONTROLLERAXISMOTION)] = EVENT_TYPE_BIT(SDL_CONTROLLERAXISMOTION) | EVENT_TYPE_BIT(SDL_CONTROLLERBUTTONDOWN) |
+                                                  EVENT_TYPE_BIT(SDL_CONTROLLERBUTTONUP) | EVENT_TYPE_BIT(SDL_CONTROLLERDEVICEADDED) |
+                                                  EVENT_TYPE_BIT(SDL_CONTROLLERDEVICEREMOVED) | EVENT_TYPE_BIT(SDL_CONTROLLERDEVICEREMAPPED),
+};
+
+/* Event types that are never even generated, the filter would drop them anyway. */
+static const Uint32 ignored_event_types[] = {
+    SDL_KEYUP, SDL_TEXTEDITING, SDL_TEXTINPUT, SDL_MOUSEMOTION, SDL_MOUSEBUTTONUP, SDL_MOUSEWHEEL,
+    SDL_FINGERDOWN, SDL_FINGERUP, SDL_FINGERMOTION, SDL_DOLLARGESTURE, SDL_DOLLARRECORD, SDL_MULTIGESTURE};
+
+static bool is_event_type_in(const Uint32 *event_types, Uint32 event_type)
+{
+    return event_type < EVENT_TYPE_BITSET_WORDS * 32 && (event_types[EVENT_TYPE_WORD(event_type)] & EVENT_TYPE_BIT(event_type)) != 0;
+}
+
+/* SDL event filter, runs before an event is copied into the queue. */
+static int filter_queued_events(void *userdata, SDL_Event *event)
+{
+    (void)userdata;
+    if (is_event_type_in(queued_events, event->type))
+    {
+        return 1;
+    }
+    SDL_AtomicAdd(&events_dropped_count, 1);
+    return 0;
+}
+
+/* Keep events nothing reads out of SDL's queue, called once SDL's event system is up. */
+static void install_event_filter(void)
+{
+    for (size_t type_index = 0; type_index < sizeof(ignored_event_types) / sizeof(ignored_event_types[0]); type_index++)
+    {
+        SDL_EventState(ignored_event_types[type_index], SDL_IGNORE);
+    }
+    SDL_SetEventFilter(filter_queued_events, NULL);
+}
+
+/* Index of the render driver called name, -1 if there is none. */
+static int find_render_driver(const char *name)
+{
+    SDL_RendererInfo driver_info;
+    for (int driver_index = 0; driver_index < SDL_GetNumRenderDrivers(); driver_index++)
+    {
+        if (SDL_GetRenderDriverInfo(driver_index, &driver_info) == 0 && strcmp(driver_info.name, name) == 0)
+        {
+            return driver_index;
+        }
+    }
+    return -1;
+}
 
 int initialize_sdl_core(CoreSDLComponents *core_components, char *window_title)
 {
@@ -10,12 +116,50 @@ int initialize_sdl_core(CoreSDLComponents *core_components, char *window_title)
     {
         window_title = "";
     }
+    core_components->window = NULL;
+    core_components->offscreen_surface = NULL;
+
+    /* Headless runs must not need a display server, the dummy driver still provides an event queue. */
+    if (core_components->headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+
     /* Initialize SDL */
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         SDL_Log("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
         return 1;
     }
+    install_event_filter();
+
+    if (core_components->headless)
+    {
+        /* Render into a plain surface so frames can be timed and captured without a window. */
+        core_components->offscreen_surface = track_surface(SDL_CreateRGBSurfaceWithFormat(0, core_components->window_width,
+                                                                                          core_components->window_height, 32, SDL_PIXELFORMAT_ARGB8888),
+                                                           __func__);
+        if (!core_components->offscreen_surface)
+        {
+            SDL_Log("Offscreen surface could not be created! SDL_Error: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 1;
+        }
+
+        core_components->renderer = SDL_CreateSoftwareRenderer(core_components->offscreen_surface);
+        if (!core_components->renderer)
+        {
+            SDL_Log("Software renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+            free_surface(core_components->offscreen_surface);
+            SDL_Quit();
+            return 1;
+        }
+        core_components->controller = NULL;
+        core_components->renderer_name = "software";
+        render_batch_init(&core_components->render_batch, core_components->renderer, core_components->window_width, core_components->window_height);
+        SDL_RenderClear(core_components->renderer);
+        return 0;
+    }
 
     /* Initialize window */
     core_components->window = SDL_CreateWindow(window_title,
@@ -29,8 +173,26 @@ int initialize_sdl_core(CoreSDLComponents *core_components, char *window_title)
         return 1;
     }
 
-    /* Initialize renderer */
-    core_components->renderer = SDL_CreateRenderer(core_components->window, -1, SDL_RENDERER_ACCELERATED);
+    /* Initialize renderer, a requested or probed driver is tried first, then SDL's own accelerated pick. */
+    const char *renderer_name = core_components->requested_renderer;
+    if (core_components->should_probe_renderer)
+    {
+        renderer_name = probe_fastest_renderer(core_components->window, core_components->window_width, core_components->window_height);
+    }
+    core_components->renderer = NULL;
+    if (renderer_name != NULL)
+    {
+        int driver_index = find_render_driver(renderer_name);
+        core_components->renderer = driver_index >= 0 ? SDL_CreateRenderer(core_components->window, driver_index, 0) : NULL;
+        if (!core_components->renderer)
+        {
+            SDL_Log("Render driver %s is unavailable, using the default", renderer_name);
+        }
+    }
+    if (!core_components->renderer)
+    {
+        core_components->renderer = SDL_CreateRenderer(core_components->window, -1, SDL_RENDERER_ACCELERATED);
+    }
     if (!core_components->renderer)
     {
         SDL_Log("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
@@ -38,6 +200,9 @@ int initialize_sdl_core(CoreSDLComponents *core_components, char *window_title)
         SDL_Quit();
         return 1;
     }
+    render_batch_init(&core_components->render_batch, core_components->renderer, core_components->window_width, core_components->window_height);
+    SDL_RendererInfo renderer_info;
+    core_components->renderer_name = SDL_GetRendererInfo(core_components->renderer, &renderer_info) == 0 ? renderer_info.name : NULL;
 
     /* Initialize controller */
     if (SDL_Init(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER) < 0)
@@ -85,6 +250,136 @@ void free_sdl_core(CoreSDLComponents *core_components)
     {
         SDL_DestroyWindow(core_components->window);
     }
+    if (core_components->offscreen_surface != NULL)
+    {
+        free_surface(core_components->offscreen_surface);
+    }
+}
+
+/* Milliseconds per frame of a UI shaped frame, or a negative value if the renderer can't draw it. */
+static double time_probe_frames(SDL_Renderer *renderer, RenderBatch *batch, int width, int height)
+{
+    /* Stand-ins for the background, the brick sprite atlas and a menu line, their pixels don't matter. */
+    SDL_Texture *background = track_texture(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height), __func__);
+    SDL_Texture *sprite_atlas = track_texture(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 1024, 1024), __func__);
+    SDL_Texture *text = track_texture(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 400, 40), __func__);
+    double millis_per_frame = -1.0;
+    if (background != NULL && sprite_atlas != NULL && text != NULL)
+    {
+        SDL_SetTextureBlendMode(sprite_atlas, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureBlendMode(text, SDL_BLENDMODE_BLEND);
+        render_batch_init(batch, renderer, width, height);
+
+        /* The first frame pays for driver warmup and uploads, it isn't timed. */
+        Uint64 ticks_per_millisecond = SDL_GetPerformanceFrequency() / 1000;
+        Uint64 timing_start = 0;
+        int timed_frames = 0;
+        for (int frame = 0; timed_frames < 3 || SDL_GetPerformanceCounter() - timing_start < RENDERER_PROBE_MILLIS * ticks_per_millisecond; frame++)
+        {
+            if (frame == 1)
+            {
+                timing_start = SDL_GetPerformanceCounter();
+            }
+            SDL_RenderClear(renderer);
+            render_batch_copy(batch, background, NULL, NULL);
+            render_batch_fill_rect(batch, &(SDL_Rect){20, 96, 512, 516}, (SDL_Color){0, 0, 0, 255});
+            render_batch_fill_rect(batch, &(SDL_Rect){25, 101, 502, 506}, (SDL_Color){255, 128, 0, 255});
+            for (int tile = 0; tile < 117; tile++)
+            {
+                SDL_Rect source = {(tile % 32) * 32, (tile / 32) * 32, 32, 32};
+                SDL_Rect destination = {10 + (tile % 12) * 32 + 64, 99 + (tile / 12) * 32 + 32, 32, 32};
+                render_batch_copy(batch, sprite_atlas, &source, &destination);
+            }
+            for (int line = 0; line < 6; line++)
+            {
+                render_batch_copy(batch, text, NULL, &(SDL_Rect){570, 150 + line * 60, 400, 40});
+            }
+            render_batch_flush(batch);
+            SDL_RenderPresent(renderer);
+            timed_frames += frame > 0 ? 1 : 0;
+        }
+        millis_per_frame = (double)(SDL_GetPerformanceCounter() - timing_start) / ticks_per_millisecond / timed_frames;
+    }
+    destroy_texture(background);
+    destroy_texture(sprite_atlas);
+    destroy_texture(text);
+    return millis_per_frame;
+}
+
+const char *probe_fastest_renderer(SDL_Window *window, int width, int height)
+{
+    RenderBatch *batch = malloc(sizeof(RenderBatch));
+    if (batch == NULL)
+    {
+        return NULL;
+    }
+    /* Probe frames aren't part of the session, keep them out of the draw call counter. */
+    Uint64 session_draw_call_count = draw_call_count;
+    const char *fastest_name = NULL;
+    double fastest_millis = 0.0;
+    SDL_RendererInfo driver_info;
+    for (int driver_index = 0; driver_index < SDL_GetNumRenderDrivers(); driver_index++)
+    {
+        if (SDL_GetRenderDriverInfo(driver_index, &driver_info) != 0)
+        {
+            continue;
+        }
+        SDL_Renderer *renderer = SDL_CreateRenderer(window, driver_index, 0);
+        if (renderer == NULL)
+        {
+            printf("Renderer probe: %s unavailable (%s)\n", driver_info.name, SDL_GetError());
+            continue;
+        }
+        double millis_per_frame = time_probe_frames(renderer, batch, width, height);
+        SDL_DestroyRenderer(renderer);
+        if (millis_per_frame < 0.0)
+        {
+            printf("Renderer probe: %s can't draw the probe frame\n", driver_info.name);
+            continue;
+        }
+        printf("Renderer probe: %s %.3f ms/frame\n", driver_info.name, millis_per_frame);
+        if (fastest_name == NULL || millis_per_frame < fastest_millis)
+        {
+            fastest_name = driver_info.name;
+            fastest_millis = millis_per_frame;
+        }
+    }
+    draw_call_count = session_draw_call_count;
+    free(batch);
+    return fastest_name;
+}
+
+int save_frame_to_png(CoreSDLComponents *core_components, const char *png_path)
+{
+    if (core_components->offscreen_surface != NULL)
+    {
+        /* The software renderer draws straight into the surface, nothing to read back. */
+        if (IMG_SavePNG(core_components->offscreen_surface, png_path) != 0)
+        {
+            SDL_Log("Unable to save frame to %s ! IMG_Error: %s\n", png_path, IMG_GetError());
+            return 1;
+        }
+        return 0;
+    }
+
+    SDL_Surface *frame_surface = track_surface(SDL_CreateRGBSurfaceWithFormat(0, core_components->window_width, core_components->window_height,
+                                                                              32, SDL_PIXELFORMAT_ARGB8888),
+                                               __func__);
+    if (!frame_surface)
+    {
+        SDL_Log("Unable to create frame surface! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    int result = 0;
+    if (SDL_RenderReadPixels(core_components->renderer, NULL, SDL_PIXELFORMAT_ARGB8888, frame_surface->pixels, frame_surface->pitch) != 0 ||
+        IMG_SavePNG(frame_surface, png_path) != 0)
+    {
+        SDL_Log("Unable to save frame to %s ! SDL_Error: %s\n", png_path, SDL_GetError());
+        result = 1;
+    }
+    free_surface(frame_surface);
+    return result;
 }
 
 void free_sprite(Sprite *sprite)
@@ -96,55 +391,174 @@ void free_sprite(Sprite *sprite)
 
     if (sprite->sprite_texture != NULL)
     {
-        SDL_DestroyTexture(sprite->sprite_texture);
+        destroy_texture(sprite->sprite_texture);
         sprite->sprite_texture = NULL;
     }
 
-    if (sprite->animations != NULL)
-    {
-        free(sprite->animations);
-        sprite->animations = NULL;
-    }
+    sprite->animations = NULL;
+    free_sprite_atlas(&sprite->atlas);
 }
 
-void update_sprite_render(SDL_Renderer *renderer, Sprite *sprite, int position_x, int position_y)
+void update_sprite_render(RenderBatch *batch, Sprite *sprite, int position_x, int position_y, Uint32 now_millis)
 {
     /* Get the current animation and frame to render */
     AnimationInfo *current_animation = &sprite->animations[sprite->current_animation_index];
     int sprite_sheet_offset = current_animation->frame_indicies[current_animation->current_frame_index];
     int frame_duration = current_animation->frame_duration_millis[current_animation->current_frame_index];
 
-    /* Offset the frame index by the width of the sprite to display the next frame */
-    SDL_Rect src_rect = {sprite_sheet_offset * sprite->sprite_width, 0, sprite->sprite_width, sprite->sprite_height};
+    if (sprite->atlas.frames != NULL)
+    {
+        /* Copy each tile of the frame from the atlas to its place inside the frame. */
+        const SpriteAtlasFrame *frame = &sprite->atlas.frames[sprite_sheet_offset];
+        for (uint32_t placement_index = 0; placement_index < frame->placement_count; placement_index++)
+        {
+            const SpriteAtlasPlacement *placement = &sprite->atlas.placements[frame->first_placement + placement_index];
+            SDL_Rect src_rect = {placement->atlas_x, placement->atlas_y, placement->width, placement->height};
+            SDL_Rect dst_rect = {position_x + placement->frame_x, position_y + placement->frame_y, placement->width, placement->height};
+            render_batch_copy(batch, sprite->sprite_texture, &src_rect, &dst_rect);
+        }
+    }
+    else
+    {
+        /* Offset the frame index by the width of the sprite to display the next frame */
+        SDL_Rect src_rect = {sprite_sheet_offset * sprite->sprite_width, 0, sprite->sprite_width, sprite->sprite_height};
 
-    /* Position the sprite at x, y with the width and height of the sprite and copy to the renderer. */
-    SDL_Rect dst_rect = {position_x, position_y, sprite->sprite_width, sprite->sprite_height};
-    SDL_RenderCopy(renderer, sprite->sprite_texture, &src_rect, &dst_rect);
+        /* Position the sprite at x, y with the width and height of the sprite and copy to the renderer. */
+        SDL_Rect dst_rect = {position_x, position_y, sprite->sprite_width, sprite->sprite_height};
+        render_batch_copy(batch, sprite->sprite_texture, &src_rect, &dst_rect);
+    }
 
     /* Update the frame index for the next sprite */
-    Uint32 current_time_millis = SDL_GetTicks();
-    if (current_time_millis - current_animation->last_frame_time_millis >= frame_duration)
+    if (now_millis - current_animation->last_frame_time_millis >= frame_duration)
     {
         current_animation->current_frame_index = (current_animation->current_frame_index + 1) % current_animation->frame_count;
-        current_animation->last_frame_time_millis = current_time_millis;
+        current_animation->last_frame_time_millis = now_millis;
     }
 }
 
+void render_batch_init(RenderBatch *batch, SDL_Renderer *renderer, int target_width, int target_height)
+{
+    batch->renderer = renderer;
+    batch->target_width = target_width;
+    batch->target_height = target_height;
+    batch->texture = NULL;
+    batch->quad_count = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    /* Every quad is two triangles over its own four vertices, so the indices never change. */
+    for (int quad_index = 0; quad_index < RENDER_BATCH_QUAD_CAPACITY; quad_index++)
+    {
+        static const int quad_corners[] = {0, 1, 2, 2, 1, 3};
+        for (int corner = 0; corner < 6; corner++)
+        {
+            batch->indices[quad_index * 6 + corner] = quad_index * 4 + quad_corners[corner];
+        }
+    }
+#endif
+}
+
+static void queue_quad(RenderBatch *batch, SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *destination, SDL_Color color)
+{
+    if (batch->quad_count > 0 && (texture != batch->texture || batch->quad_count == RENDER_BATCH_QUAD_CAPACITY))
+    {
+        render_batch_flush(batch);
+    }
+    /* Queried at the start of every run, a recreated texture can come back at the same address. */
+    if (batch->quad_count == 0 && texture != NULL)
+    {
+        SDL_QueryTexture(texture, NULL, NULL, &batch->texture_width, &batch->texture_height);
+    }
+    batch->texture = texture;
+
+    RenderBatchQuad *quad = &batch->quads[batch->quad_count++];
+    quad->source = source != NULL ? *source : (SDL_Rect){0, 0, batch->texture_width, batch->texture_height};
+    quad->destination = destination != NULL ? *destination : (SDL_Rect){0, 0, batch->target_width, batch->target_height};
+    quad->color = color;
+}
+
+void render_batch_copy(RenderBatch *batch, SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *destination)
+{
+    if (texture == NULL)
+    {
+        return;
+    }
+    queue_quad(batch, texture, source, destination, (SDL_Color){255, 255, 255, 255});
+}
+
+void render_batch_fill_rect(RenderBatch *batch, const SDL_Rect *rect, SDL_Color color)
+{
+    queue_quad(batch, NULL, NULL, rect, color);
+}
+
+void render_batch_flush(RenderBatch *batch)
+{
+    if (batch->quad_count == 0)
+    {
+        return;
+    }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    float texture_width = batch->texture_width > 0 ? (float)batch->texture_width : 1.0f;
+    float texture_height = batch->texture_height > 0 ? (float)batch->texture_height : 1.0f;
+    for (int quad_index = 0; quad_index < batch->quad_count; quad_index++)
+    {
+        const RenderBatchQuad *quad = &batch->quads[quad_index];
+        SDL_Vertex *vertices = &batch->vertices[quad_index * 4];
+        float left = (float)quad->destination.x;
+        float top = (float)quad->destination.y;
+        float right = (float)(quad->destination.x + quad->destination.w);
+        float bottom = (float)(quad->destination.y + quad->destination.h);
+        float u_left = quad->source.x / texture_width;
+        float v_top = quad->source.y / texture_height;
+        float u_right = (quad->source.x + quad->source.w) / texture_width;
+        float v_bottom = (quad->source.y + quad->source.h) / texture_height;
+        vertices[0] = (SDL_Vertex){{left, top}, quad->color, {u_left, v_top}};
+        vertices[1] = (SDL_Vertex){{right, top}, quad->color, {u_right, v_top}};
+        vertices[2] = (SDL_Vertex){{left, bottom}, quad->color, {u_left, v_bottom}};
+        vertices[3] = (SDL_Vertex){{right, bottom}, quad->color, {u_right, v_bottom}};
+    }
+    SDL_RenderGeometry(batch->renderer, batch->texture, batch->vertices, batch->quad_count * 4, batch->indices, batch->quad_count * 6);
+    draw_call_count++;
+#else
+    /* SDL before 2.0.18 has no SDL_RenderGeometry, submit the quads one by one. */
+    for (int quad_index = 0; quad_index < batch->quad_count; quad_index++)
+    {
+        const RenderBatchQuad *quad = &batch->quads[quad_index];
+        if (batch->texture != NULL)
+        {
+            SDL_RenderCopy(batch->renderer, batch->texture, &quad->source, &quad->destination);
+        }
+        else
+        {
+            SDL_SetRenderDrawColor(batch->renderer, quad->color.r, quad->color.g, quad->color.b, quad->color.a);
+            SDL_RenderFillRect(batch->renderer, &quad->destination);
+        }
+        draw_call_count++;
+    }
+#endif
+    batch->quad_count = 0;
+}
+
 SDL_Texture *create_sdl_texture_from_image(SDL_Renderer *renderer, const char *full_image_path)
 {
-    SDL_Surface *surface = IMG_Load(full_image_path);
+    SDL_Surface *surface = track_surface(IMG_Load(full_image_path), __func__);
     if (!surface)
     {
         SDL_Log("Unable to load image %s ! IMG_Error: %s\n", full_image_path, IMG_GetError());
         return NULL;
     }
+    return create_sdl_texture_from_surface(renderer, surface);
+}
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+SDL_Texture *create_sdl_texture_from_surface(SDL_Renderer *renderer, SDL_Surface *surface)
+{
+    SDL_Texture *texture = track_texture(SDL_CreateTextureFromSurface(renderer, surface), __func__);
+    free_surface(surface);
     if (!texture)
     {
         SDL_Log("Unable to create image texture! SDL_Error: %s\n", SDL_GetError());
+        return NULL;
     }
+    textures_created_count++;
     return texture;
 }
 
@@ -156,17 +570,17 @@ SDL_Texture *create_text_texture(SDL_Renderer *renderer, TTF_Font *font, const S
         SDL_Color default_shadow_color = {0, 0, 0, 1};
         shadow_color = &default_shadow_color;
     }
-    SDL_Surface *shadow_surface = TTF_RenderText_Solid(font, text, *shadow_color);
+    SDL_Surface *shadow_surface = track_surface(TTF_RenderText_Solid(font, text, *shadow_color), __func__);
     if (!shadow_surface)
     {
         return NULL;
     }
 
     /* Render main text surface */
-    SDL_Surface *text_surface = TTF_RenderText_Solid(font, text, *text_color);
+    SDL_Surface *text_surface = track_surface(TTF_RenderText_Solid(font, text, *text_color), __func__);
     if (!text_surface)
     {
-        SDL_FreeSurface(text_surface);
+        free_surface(shadow_surface);
         return NULL;
     }
 
@@ -174,12 +588,13 @@ SDL_Texture *create_text_texture(SDL_Renderer *renderer, TTF_Font *font, const S
     int shadow_offset = 4;
     int width = text_surface->w + shadow_offset;
     int height = text_surface->h + shadow_offset;
-    SDL_Surface *combined_surface = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    SDL_Surface *combined_surface = track_surface(SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000),
+                                                  __func__);
 
     if (!combined_surface)
     {
-        SDL_FreeSurface(shadow_surface);
-        SDL_FreeSurface(text_surface);
+        free_surface(shadow_surface);
+        free_surface(text_surface);
         return NULL;
     }
 
@@ -192,16 +607,682 @@ SDL_Texture *create_text_texture(SDL_Renderer *renderer, TTF_Font *font, const S
     SDL_BlitSurface(text_surface, NULL, combined_surface, &text_rect);
 
     /* Create texture from combined surface */
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, combined_surface);
+    SDL_Texture *texture = track_texture(SDL_CreateTextureFromSurface(renderer, combined_surface), __func__);
 
     /* Free the surfaces */
-    SDL_FreeSurface(shadow_surface);
-    SDL_FreeSurface(text_surface);
-    SDL_FreeSurface(combined_surface);
+    free_surface(shadow_surface);
+    free_surface(text_surface);
+    free_surface(combined_surface);
+
+    if (texture)
+    {
+        textures_created_count++;
+    }
+    return texture;
+}
+
+int open_asset_pack(AssetPack *pack, const char *pack_path)
+{
+    memset(pack, 0, sizeof(*pack));
+    int file_descriptor = open(pack_path, O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        return 1;
+    }
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0 || (size_t)file_status.st_size < sizeof(AssetPackHeader))
+    {
+        close(file_descriptor);
+        return 1;
+    }
+    void *mapping = mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    close(file_descriptor);
+    if (mapping == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    pack->data = mapping;
+    pack->size = file_status.st_size;
+
+    /* Reject packs from another version or cut short, every entry must lie inside the mapping. */
+    const AssetPackHeader *header = (const AssetPackHeader *)pack->data;
+    size_t index_end = sizeof(AssetPackHeader) + (size_t)header->entry_count * sizeof(AssetPackEntry);
+    bool is_valid = header->magic == ASSET_PACK_MAGIC && header->version == ASSET_PACK_VERSION && index_end <= pack->size;
+    const AssetPackEntry *entries = (const AssetPackEntry *)(pack->data + sizeof(AssetPackHeader));
+    for (uint32_t entry_index = 0; is_valid && entry_index < header->entry_count; entry_index++)
+    {
+        const AssetPackEntry *entry = &entries[entry_index];
+        is_valid = entry->offset % ASSET_PACK_ALIGNMENT == 0 && entry->offset <= pack->size && entry->size <= pack->size - entry->offset &&
+                   (uint64_t)entry->pitch * entry->height <= entry->size && memchr(entry->name, '\0', sizeof(entry->name)) != NULL;
+    }
+    if (!is_valid)
+    {
+        SDL_Log("Ignoring invalid asset pack %s", pack_path);
+        close_asset_pack(pack);
+        return 1;
+    }
+    pack->entries = entries;
+    pack->entry_count = header->entry_count;
+    return 0;
+}
+
+void close_asset_pack(AssetPack *pack)
+{
+    if (pack->data != NULL)
+    {
+        munmap((void *)pack->data, pack->size);
+    }
+    memset(pack, 0, sizeof(*pack));
+}
+
+const AssetPackEntry *find_asset_pack_entry(const AssetPack *pack, const char *image_path)
+{
+    const char *last_slash = strrchr(image_path, '/');
+    const char *image_name = last_slash != NULL ? last_slash + 1 : image_path;
+    for (uint32_t entry_index = 0; entry_index < pack->entry_count; entry_index++)
+    {
+        if (strcmp(pack->entries[entry_index].name, image_name) == 0)
+        {
+            return &pack->entries[entry_index];
+        }
+    }
+    return NULL;
+}
+
+SDL_Texture *create_sdl_texture_from_asset_pack(SDL_Renderer *renderer, const AssetPack *pack, const AssetPackEntry *entry, Uint32 texture_format)
+{
+    /* Wraps the mapping, nothing is copied unless the pixels need converting. */
+    SDL_Surface *surface = track_surface(SDL_CreateRGBSurfaceWithFormatFrom((void *)(pack->data + entry->offset), entry->width, entry->height,
+                                                                            SDL_BITSPERPIXEL(entry->pixel_format), entry->pitch, entry->pixel_format),
+                                         __func__);
+    if (!surface)
+    {
+        SDL_Log("Unable to wrap %s from the asset pack! SDL_Error: %s\n", entry->name, SDL_GetError());
+        return NULL;
+    }
+    return create_sdl_texture_in_format(renderer, surface, texture_format);
+}
+
+ImageAlphaType get_surface_alpha_type(SDL_Surface *surface)
+{
+    Uint32 alpha_mask = surface->format->Amask;
+    if (alpha_mask == 0)
+    {
+        /* Paletted PNGs mark their transparent color with a color key */
+        return SDL_HasColorKey(surface) ? IMAGE_ALPHA_BINARY : IMAGE_ALPHA_OPAQUE;
+    }
+    if (surface->format->BytesPerPixel != 4 || SDL_LockSurface(surface) != 0)
+    {
+        return IMAGE_ALPHA_BLENDED;
+    }
+
+    ImageAlphaType alpha_type = IMAGE_ALPHA_OPAQUE;
+    for (int row = 0; alpha_type != IMAGE_ALPHA_BLENDED && row < surface->h; row++)
+    {
+        const Uint32 *pixels = (const Uint32 *)((const Uint8 *)surface->pixels + (size_t)row * surface->pitch);
+        for (int column = 0; column < surface->w; column++)
+        {
+            Uint32 alpha = pixels[column] & alpha_mask;
+            if (alpha != 0 && alpha != alpha_mask)
+            {
+                alpha_type = IMAGE_ALPHA_BLENDED;
+                break;
+            }
+            if (alpha == 0)
+            {
+                alpha_type = IMAGE_ALPHA_BINARY;
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return alpha_type;
+}
+
+Uint32 choose_texture_format(SDL_Renderer *renderer, ImageAlphaType alpha_type, bool allow_16_bit)
+{
+    /* Candidates in order of preference, ARGB8888 is always accepted since SDL converts to a native format itself. */
+    static const Uint32 opaque_formats[] = {SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB888};
+    static const Uint32 binary_alpha_formats[] = {SDL_PIXELFORMAT_ARGB1555, SDL_PIXELFORMAT_ARGB4444};
+    const Uint32 *candidates = NULL;
+    int candidate_count = 0;
+    if (alpha_type == IMAGE_ALPHA_OPAQUE)
+    {
+        candidates = opaque_formats;
+        candidate_count = sizeof(opaque_formats) / sizeof(opaque_formats[0]);
+    }
+    else if (alpha_type == IMAGE_ALPHA_BINARY)
+    {
+        candidates = binary_alpha_formats;
+        candidate_count = sizeof(binary_alpha_formats) / sizeof(binary_alpha_formats[0]);
+    }
+
+    SDL_RendererInfo renderer_info;
+    if (SDL_GetRendererInfo(renderer, &renderer_info) != 0)
+    {
+        return SDL_PIXELFORMAT_ARGB8888;
+    }
+    for (int candidate_index = 0; candidate_index < candidate_count; candidate_index++)
+    {
+        if (!allow_16_bit && SDL_BYTESPERPIXEL(candidates[candidate_index]) < 4)
+        {
+            continue;
+        }
+        for (Uint32 format_index = 0; format_index < renderer_info.num_texture_formats; format_index++)
+        {
+            if (renderer_info.texture_formats[format_index] == candidates[candidate_index])
+            {
+                return candidates[candidate_index];
+            }
+        }
+    }
+    return SDL_PIXELFORMAT_ARGB8888;
+}
 
+SDL_Texture *create_sdl_texture_in_format(SDL_Renderer *renderer, SDL_Surface *surface, Uint32 texture_format)
+{
+    SDL_Surface *converted = surface->format->format == texture_format ? surface
+                                                                       : track_surface(SDL_ConvertSurfaceFormat(surface, texture_format, 0), __func__);
+    SDL_Texture *texture = NULL;
+    if (converted != NULL)
+    {
+        texture = SDL_CreateTexture(renderer, texture_format, SDL_TEXTUREACCESS_STATIC, converted->w, converted->h);
+        if (texture != NULL && SDL_UpdateTexture(texture, NULL, converted->pixels, converted->pitch) != 0)
+        {
+            SDL_DestroyTexture(texture);
+            texture = NULL;
+        }
+    }
+    if (converted != surface)
+    {
+        free_surface(converted);
+    }
+    free_surface(surface);
+
+    if (!texture)
+    {
+        SDL_Log("Unable to create %s texture! SDL_Error: %s\n", SDL_GetPixelFormatName(texture_format), SDL_GetError());
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_ISPIXELFORMAT_ALPHA(texture_format) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+    track_texture(texture, __func__);
+    textures_created_count++;
+    return texture;
+}
+
+size_t get_texture_byte_count(SDL_Texture *texture)
+{
+    Uint32 format;
+    int width;
+    int height;
+    if (texture == NULL || SDL_QueryTexture(texture, &format, NULL, &width, &height) != 0)
+    {
+        return 0;
+    }
+    return (size_t)width * height * SDL_BYTESPERPIXEL(format);
+}
+
+int load_sprite_atlas(SpriteAtlas *atlas, const char *index_path)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    FILE *file = fopen(index_path, "rb");
+    if (!file)
+    {
+        return 1;
+    }
+    SpriteAtlasHeader header;
+    bool is_valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == SPRITE_ATLAS_MAGIC &&
+                    header.version == SPRITE_ATLAS_VERSION && header.frame_count > 0 && header.frame_count <= UINT16_MAX &&
+                    header.placement_count <= header.frame_count * (uint32_t)UINT16_MAX;
+    if (is_valid)
+    {
+        atlas->frames = calloc(header.frame_count, sizeof(SpriteAtlasFrame));
+        atlas->placements = calloc(header.placement_count > 0 ? header.placement_count : 1, sizeof(SpriteAtlasPlacement));
+        is_valid = atlas->frames != NULL && atlas->placements != NULL &&
+                   fread(atlas->frames, sizeof(SpriteAtlasFrame), header.frame_count, file) == header.frame_count &&
+                   fread(atlas->placements, sizeof(SpriteAtlasPlacement), header.placement_count, file) == header.placement_count;
+    }
+    fclose(file);
+
+    /* Every frame must reference placements that exist, and every placement must stay inside its frame. */
+    for (uint32_t frame_index = 0; is_valid && frame_index < header.frame_count; frame_index++)
+    {
+        const SpriteAtlasFrame *frame = &atlas->frames[frame_index];
+        is_valid = frame->first_placement <= header.placement_count && frame->placement_count <= header.placement_count - frame->first_placement;
+    }
+    for (uint32_t placement_index = 0; is_valid && placement_index < header.placement_count; placement_index++)
+    {
+        const SpriteAtlasPlacement *placement = &atlas->placements[placement_index];
+        is_valid = placement->frame_x + placement->width <= header.frame_width && placement->frame_y + placement->height <= header.frame_height;
+    }
+    if (!is_valid)
+    {
+        SDL_Log("Ignoring invalid sprite atlas index %s", index_path);
+        free_sprite_atlas(atlas);
+        return 1;
+    }
+    atlas->frame_count = header.frame_count;
+    atlas->placement_count = header.placement_count;
+    atlas->frame_width = header.frame_width;
+    atlas->frame_height = header.frame_height;
+    return 0;
+}
+
+void free_sprite_atlas(SpriteAtlas *atlas)
+{
+    free(atlas->frames);
+    free(atlas->placements);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+Uint64 get_textures_created_count(void)
+{
+    return textures_created_count;
+}
+
+Uint64 get_draw_call_count(void)
+{
+    return draw_call_count;
+}
+
+static void track_resource(const void *resource, const char *site, size_t byte_count, bool is_texture)
+{
+    SDL_AtomicLock(&tracked_resources_lock);
+    bool is_full = tracked_resource_count == TRACKED_RESOURCE_CAPACITY;
+    if (!is_full)
+    {
+        tracked_resources[tracked_resource_count++] = (TrackedResource){resource, site, byte_count, is_texture};
+    }
+    SDL_AtomicUnlock(&tracked_resources_lock);
+    if (is_full)
+    {
+        SDL_Log("Resource accounting is full, %s from %s isn't counted", is_texture ? "texture" : "surface", site);
+    }
+}
+
+static void untrack_resource(const void *resource)
+{
+    SDL_AtomicLock(&tracked_resources_lock);
+    for (int resource_index = 0; resource_index < tracked_resource_count; resource_index++)
+    {
+        if (tracked_resources[resource_index].resource == resource)
+        {
+            tracked_resources[resource_index] = tracked_resources[--tracked_resource_count];
+            break;
+        }
+    }
+    SDL_AtomicUnlock(&tracked_resources_lock);
+}
+
+SDL_Texture *track_texture(SDL_Texture *texture, const char *site)
+{
+    if (texture != NULL)
+    {
+        track_resource(texture, site, get_texture_byte_count(texture), true);
+    }
     return texture;
 }
 
+void destroy_texture(SDL_Texture *texture)
+{
+    if (texture != NULL)
+    {
+        untrack_resource(texture);
+        SDL_DestroyTexture(texture);
+    }
+}
+
+SDL_Surface *track_surface(SDL_Surface *surface, const char *site)
+{
+    if (surface != NULL)
+    {
+        track_resource(surface, site, (size_t)surface->pitch * surface->h, false);
+    }
+    return surface;
+}
+
+void free_surface(SDL_Surface *surface)
+{
+    if (surface != NULL)
+    {
+        untrack_resource(surface);
+        SDL_FreeSurface(surface);
+    }
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+/* SDL's own memory functions, the counting wrappers forward to them. */
+static SDL_malloc_func real_malloc = NULL;
+static SDL_calloc_func real_calloc = NULL;
+static SDL_realloc_func real_realloc = NULL;
+static SDL_free_func real_free = NULL;
+
+static void *counting_malloc(size_t size)
+{
+    SDL_AtomicAdd(&allocation_count, 1);
+    return real_malloc(size);
+}
+
+static void *counting_calloc(size_t member_count, size_t size)
+{
+    SDL_AtomicAdd(&allocation_count, 1);
+    return real_calloc(member_count, size);
+}
+
+static void *counting_realloc(void *memory, size_t size)
+{
+    SDL_AtomicAdd(&allocation_count, 1);
+    return real_realloc(memory, size);
+}
+
+static void counting_free(void *memory)
+{
+    real_free(memory);
+}
+#endif
+
+void install_allocation_counter(void)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+    if (real_malloc == NULL)
+    {
+        SDL_GetMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+        SDL_SetMemoryFunctions(counting_malloc, counting_calloc, counting_realloc, counting_free);
+    }
+#endif
+}
+
+void get_resource_counts(ResourceCounts *counts)
+{
+    *counts = (ResourceCounts){0};
+    SDL_AtomicLock(&tracked_resources_lock);
+    for (int resource_index = 0; resource_index < tracked_resource_count; resource_index++)
+    {
+        const TrackedResource *resource = &tracked_resources[resource_index];
+        if (resource->is_texture)
+        {
+            counts->live_textures++;
+            counts->live_texture_bytes += resource->byte_count;
+        }
+        else
+        {
+            counts->live_surfaces++;
+            counts->live_surface_bytes += resource->byte_count;
+        }
+    }
+    SDL_AtomicUnlock(&tracked_resources_lock);
+    counts->allocation_count = (Uint32)SDL_AtomicGet(&allocation_count);
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+    counts->live_allocation_count = SDL_GetNumAllocations();
+#else
+    counts->live_allocation_count = -1;
+#endif
+}
+
+void log_live_resources(void)
+{
+    SDL_AtomicLock(&tracked_resources_lock);
+    for (int resource_index = 0; resource_index < tracked_resource_count; resource_index++)
+    {
+        /* Report each site once, at its first resource. */
+        const char *site = tracked_resources[resource_index].site;
+        bool is_reported = false;
+        for (int earlier_index = 0; earlier_index < resource_index && !is_reported; earlier_index++)
+        {
+            is_reported = strcmp(tracked_resources[earlier_index].site, site) == 0;
+        }
+        if (is_reported)
+        {
+            continue;
+        }
+
+        int texture_count = 0;
+        int surface_count = 0;
+        size_t byte_count = 0;
+        for (int site_index = resource_index; site_index < tracked_resource_count; site_index++)
+        {
+            if (strcmp(tracked_resources[site_index].site, site) == 0)
+            {
+                texture_count += tracked_resources[site_index].is_texture ? 1 : 0;
+                surface_count += tracked_resources[site_index].is_texture ? 0 : 1;
+                byte_count += tracked_resources[site_index].byte_count;
+            }
+        }
+        printf("  %-34s %3d textures, %3d surfaces, %6zu KiB\n", site, texture_count, surface_count, byte_count / 1024);
+    }
+    SDL_AtomicUnlock(&tracked_resources_lock);
+}
+
+Uint32 get_events_dropped_count(void)
+{
+    return (Uint32)SDL_AtomicGet(&events_dropped_count);
+}
+
+void note_event_queue_depth(void)
+{
+    int queue_depth = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+    max_event_queue_depth = queue_depth > max_event_queue_depth ? queue_depth : max_event_queue_depth;
+}
+
+int get_max_event_queue_depth(void)
+{
+    return max_event_queue_depth;
+}
+
+static void write_input_record(InputRecorder *recorder, InputType input, Uint32 now_millis)
+{
+    Uint32 timestamp_millis = now_millis - recorder->start_millis;
+    Uint32 delta_millis = timestamp_millis - recorder->last_timestamp_millis;
+    recorder->last_timestamp_millis = timestamp_millis;
+
+    /* Unsigned LEB128, 7 bits per byte with the high bit flagging a continuation. */
+    do
+    {
+        Uint8 varint_byte = delta_millis & 0x7F;
+        delta_millis >>= 7;
+        fputc(delta_millis != 0 ? varint_byte | 0x80 : varint_byte, recorder->file);
+    } while (delta_millis != 0);
+    fputc((Uint8)input, recorder->file);
+}
+
+int input_recorder_open(InputRecorder *recorder, const char *recording_path, Uint32 start_millis)
+{
+    recorder->file = fopen(recording_path, "wb");
+    if (!recorder->file)
+    {
+        perror("fopen");
+        SDL_Log("Failed to open %s for recording", recording_path);
+        return 1;
+    }
+    recorder->start_millis = start_millis;
+    recorder->last_timestamp_millis = 0;
+
+    fwrite(INPUT_RECORDING_MAGIC, 1, strlen(INPUT_RECORDING_MAGIC), recorder->file);
+    fputc(INPUT_RECORDING_VERSION, recorder->file);
+    return 0;
+}
+
+void input_recorder_write(InputRecorder *recorder, InputType input, Uint32 now_millis)
+{
+    if (recorder->file == NULL || input == UNKNOWN)
+    {
+        return;
+    }
+
+    write_input_record(recorder, input, now_millis);
+}
+
+int input_recorder_close(InputRecorder *recorder, Uint32 now_millis)
+{
+    if (recorder->file == NULL)
+    {
+        return 1;
+    }
+
+    /* The end of session marker is written the same way as any other record. */
+    write_input_record(recorder, UNKNOWN, now_millis);
+
+    int result = fclose(recorder->file) == 0 ? 0 : 1;
+    recorder->file = NULL;
+    return result;
+}
+
+int load_input_recording(const char *recording_path, RecordedInput *inputs, int capacity)
+{
+    FILE *file = fopen(recording_path, "rb");
+    if (!file)
+    {
+        perror("fopen");
+        SDL_Log("Failed to open recording %s", recording_path);
+        return -1;
+    }
+
+    char magic[sizeof(INPUT_RECORDING_MAGIC)] = {0};
+    if (fread(magic, 1, strlen(INPUT_RECORDING_MAGIC), file) != strlen(INPUT_RECORDING_MAGIC) ||
+        strcmp(magic, INPUT_RECORDING_MAGIC) != 0 || fgetc(file) != INPUT_RECORDING_VERSION)
+    {
+        SDL_Log("%s is not a version %d input recording", recording_path, INPUT_RECORDING_VERSION);
+        fclose(file);
+        return -1;
+    }
+
+    int input_count = 0;
+    Uint32 timestamp_millis = 0;
+    while (input_count < capacity)
+    {
+        Uint32 delta_millis = 0;
+        int shift = 0;
+        int varint_byte;
+        do
+        {
+            varint_byte = fgetc(file);
+            if (varint_byte == EOF || shift > 28)
+            {
+                fclose(file);
+                return input_count;
+            }
+            delta_millis |= (Uint32)(varint_byte & 0x7F) << shift;
+            shift += 7;
+        } while (varint_byte & 0x80);
+
+        int input = fgetc(file);
+        if (input == EOF || input > SWEEP_RIGHT)
+        {
+            SDL_Log("Recording %s is truncated or corrupt after %d inputs", recording_path, input_count);
+            break;
+        }
+
+        timestamp_millis += delta_millis;
+        inputs[input_count++] = (RecordedInput){timestamp_millis, (InputType)input};
+        if (input == UNKNOWN)
+        {
+            break;
+        }
+    }
+    fclose(file);
+    return input_count;
+}
+
+bool next_due_input(InputPlayback *playback, Uint32 clock_millis, InputType *input)
+{
+    if (playback->next_input_index >= playback->input_count ||
+        playback->inputs[playback->next_input_index].timestamp_millis > clock_millis)
+    {
+        return false;
+    }
+    *input = playback->inputs[playback->next_input_index++].input;
+    return true;
+}
+
+void button_repeat_init(ButtonRepeat *repeat, Uint32 delay_millis, int acceleration_percent)
+{
+    repeat->delay_millis = delay_millis;
+    repeat->initial_interval_millis = BUTTON_REPEAT_INTERVAL_MILLIS;
+    repeat->minimum_interval_millis = BUTTON_REPEAT_MIN_INTERVAL_MILLIS;
+    repeat->acceleration_percent = acceleration_percent < 0 ? 0 : (acceleration_percent > 100 ? 100 : acceleration_percent);
+    repeat->held_button = SDL_CONTROLLER_BUTTON_MAX;
+    repeat->held_input = UNKNOWN;
+    repeat->next_repeat_millis = 0;
+    repeat->interval_millis = BUTTON_REPEAT_INTERVAL_MILLIS;
+}
+
+void button_repeat_track(ButtonRepeat *repeat, const SDL_Event *event, Uint32 now_millis)
+{
+    if (event->type == SDL_CONTROLLERBUTTONDOWN)
+    {
+        InputType input = sdl_event_to_input_type((SDL_Event *)event, false);
+        bool is_repeatable = input == DPAD_UP || input == DPAD_DOWN || input == DPAD_LEFT || input == DPAD_RIGHT || input == L1 || input == R1;
+        repeat->held_button = event->cbutton.button;
+        repeat->held_input = is_repeatable ? input : UNKNOWN;
+        repeat->next_repeat_millis = now_millis + repeat->delay_millis;
+        repeat->interval_millis = repeat->initial_interval_millis;
+    }
+    else if ((event->type == SDL_CONTROLLERBUTTONUP && event->cbutton.button == repeat->held_button) ||
+             event->type == SDL_CONTROLLERDEVICEREMOVED)
+    {
+        repeat->held_input = UNKNOWN;
+    }
+}
+
+bool next_repeated_input(ButtonRepeat *repeat, Uint32 now_millis, InputType *input)
+{
+    /* Signed difference so SDL_GetTicks() wrapping doesn't stall a held button. */
+    if (repeat->held_input == UNKNOWN || (Sint32)(now_millis - repeat->next_repeat_millis) < 0)
+    {
+        return false;
+    }
+    *input = repeat->held_input;
+    repeat->next_repeat_millis = now_millis + repeat->interval_millis;
+    Uint32 next_interval = repeat->interval_millis * (Uint32)(100 - repeat->acceleration_percent) / 100;
+    repeat->interval_millis = next_interval > repeat->minimum_interval_millis ? next_interval : repeat->minimum_interval_millis;
+    return true;
+}
+
+void analog_stick_init(AnalogStick *stick, int deadzone)
+{
+    stick->deadzone = deadzone < 0 ? 0 : (deadzone > 32000 ? 32000 : deadzone);
+    stick->x_value = 0;
+    stick->step_remainder = 0;
+    stick->last_update_millis = 0;
+}
+
+void analog_stick_track(AnalogStick *stick, const SDL_Event *event)
+{
+    if (event->type == SDL_CONTROLLERAXISMOTION && event->caxis.axis == SDL_CONTROLLER_AXIS_LEFTX)
+    {
+        stick->x_value = event->caxis.value;
+    }
+    else if (event->type == SDL_CONTROLLERDEVICEREMOVED)
+    {
+        stick->x_value = 0;
+    }
+}
+
+int analog_stick_steps(AnalogStick *stick, Uint32 now_millis, int max_steps_per_second)
+{
+    Uint32 elapsed_millis = now_millis - stick->last_update_millis;
+    stick->last_update_millis = now_millis;
+    elapsed_millis = elapsed_millis > ANALOG_STICK_MAX_FRAME_MILLIS ? ANALOG_STICK_MAX_FRAME_MILLIS : elapsed_millis;
+
+    int magnitude = stick->x_value < 0 ? -(int)stick->x_value : stick->x_value;
+    if (magnitude <= stick->deadzone)
+    {
+        stick->step_remainder = 0;
+        return 0;
+    }
+
+    /* Deflection past the deadzone in thousandths, squared for the response curve. */
+    int deflection = (magnitude - stick->deadzone) * 1000 / (32767 - stick->deadzone);
+    deflection = deflection > 1000 ? 1000 : deflection;
+    int milli_steps_per_second = deflection * deflection / 1000 * max_steps_per_second;
+    int milli_steps = (int)((Sint64)milli_steps_per_second * elapsed_millis / 1000);
+    stick->step_remainder += stick->x_value < 0 ? -milli_steps : milli_steps;
+
+    int steps = stick->step_remainder / 1000;
+    stick->step_remainder -= steps * 1000;
+    return steps;
+}
+
 InputType sdl_event_to_input_type(SDL_Event *event, bool verbose)
 {
     if (is_supported_input_event(event->type))
@@ -323,27 +1404,7 @@ InputType sdl_event_to_input_type(SDL_Event *event, bool verbose)
 
 bool is_supported_input_event(Uint32 event_type)
 {
-    const Uint32 supported_events[] = {
-        SDL_KEYDOWN,
-        SDL_MOUSEBUTTONDOWN,
-        SDL_CONTROLLERBUTTONDOWN,
-        // TODO: Add control stick support
-        // SDL_JOYAXISMOTION,
-        // SDL_JOYBALLMOTION,
-        // SDL_JOYHATMOTION,
-        // SDL_JOYBUTTONDOWN,
-        // SDL_JOYBUTTONUP,
-        SDL_QUIT};
-    const int num_supported_events = sizeof(supported_events) / sizeof(supported_events[0]);
-
-    for (int i = 0; i < num_supported_events; ++i)
-    {
-        if (event_type == supported_events[i])
-        {
-            return true;
-        }
-    }
-    return false;
+    return is_event_type_in(supported_input_events, event_type);
 }
 
 const char *get_input_type_name(Uint32 inputType)
@@ -386,11 +1447,27 @@ const char *get_input_type_name(Uint32 inputType)
         return "L3";
     case R3:
         return "R3";
+    case SWEEP_LEFT:
+        return "SWEEP_LEFT";
+    case SWEEP_RIGHT:
+        return "SWEEP_RIGHT";
     default:
         return "Unknown input type";
     }
 }
 
+InputType input_type_from_name(const char *name)
+{
+    for (InputType input_type = START; input_type <= SWEEP_RIGHT; input_type++)
+    {
+        if (strcmp(name, get_input_type_name(input_type)) == 0)
+        {
+            return input_type;
+        }
+    }
+    return UNKNOWN;
+}
+
 const char *get_event_name(Uint32 eventType)
 {
     switch (eventType)
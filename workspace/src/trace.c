@@ -0,0 +1,176 @@
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Preallocated event storage, slots are claimed with an atomic increment. */
+static TraceEvent *trace_events = NULL;
+static uint32_t trace_event_count = 0;
+static uint32_t trace_events_dropped = 0;
+static bool trace_enabled = false;
+static char trace_output_path[256];
+
+/* Small sequential ids read better in Perfetto than raw pthread handles. */
+static uint32_t trace_next_thread_id = 1;
+static __thread uint32_t trace_thread_id = 0;
+
+static uint64_t trace_now_nanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void trace_record(const char *name, char phase)
+{
+    if (!__atomic_load_n(&trace_enabled, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    if (trace_thread_id == 0)
+    {
+        trace_thread_id = __atomic_fetch_add(&trace_next_thread_id, 1, __ATOMIC_RELAXED);
+    }
+
+    uint32_t slot = __atomic_fetch_add(&trace_event_count, 1, __ATOMIC_RELAXED);
+    if (slot >= TRACE_EVENT_CAPACITY)
+    {
+        __atomic_fetch_add(&trace_events_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    TraceEvent *event = &trace_events[slot];
+    event->name = name;
+    event->timestamp_nanos = trace_now_nanos();
+    event->thread_id = trace_thread_id;
+    event->phase = phase;
+    __atomic_store_n(&event->is_ready, true, __ATOMIC_RELEASE);
+}
+
+/* Span names are usually literals, but asset names come from file paths. */
+static void trace_write_json_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const unsigned char *character = (const unsigned char *)text; *character != '\0'; character++)
+    {
+        if (*character == '"' || *character == '\\')
+        {
+            fprintf(file, "\\%c", *character);
+        }
+        else if (*character < 0x20)
+        {
+            fprintf(file, "\\u%04x", *character);
+        }
+        else
+        {
+            fputc(*character, file);
+        }
+    }
+    fputc('"', file);
+}
+
+int trace_initialize(const char *output_path)
+{
+    if (output_path == NULL || output_path[0] == '\0')
+    {
+        printf("Trace output path is empty, tracing disabled\n");
+        return 1;
+    }
+
+    trace_events = calloc(TRACE_EVENT_CAPACITY, sizeof(TraceEvent));
+    if (trace_events == NULL)
+    {
+        perror("calloc");
+        return 1;
+    }
+
+    snprintf(trace_output_path, sizeof(trace_output_path), "%s", output_path);
+    trace_event_count = 0;
+    trace_events_dropped = 0;
+    __atomic_store_n(&trace_enabled, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+bool trace_is_enabled(void)
+{
+    return __atomic_load_n(&trace_enabled, __ATOMIC_ACQUIRE);
+}
+
+void trace_begin(const char *name)
+{
+    trace_record(name, 'B');
+}
+
+void trace_end(const char *name)
+{
+    trace_record(name, 'E');
+}
+
+int trace_write(void)
+{
+    if (!trace_is_enabled())
+    {
+        return 0;
+    }
+    __atomic_store_n(&trace_enabled, false, __ATOMIC_RELEASE);
+
+    uint32_t event_count = __atomic_load_n(&trace_event_count, __ATOMIC_ACQUIRE);
+    if (event_count > TRACE_EVENT_CAPACITY)
+    {
+        event_count = TRACE_EVENT_CAPACITY;
+    }
+
+    FILE *file = fopen(trace_output_path, "w");
+    if (!file)
+    {
+        perror("fopen");
+        printf("Failed to open %s for writing\n", trace_output_path);
+        free(trace_events);
+        trace_events = NULL;
+        return 1;
+    }
+
+    /* A slot claimed by a thread that hasn't filled it in yet is skipped, it may still hold zeros. */
+    bool has_origin = false;
+    uint64_t origin_nanos = 0;
+    for (uint32_t event_index = 0; event_index < event_count; event_index++)
+    {
+        const TraceEvent *event = &trace_events[event_index];
+        if (__atomic_load_n(&event->is_ready, __ATOMIC_ACQUIRE) && (!has_origin || event->timestamp_nanos < origin_nanos))
+        {
+            /* Timestamps are relative to the first event so the timeline starts at zero. */
+            origin_nanos = event->timestamp_nanos;
+            has_origin = true;
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    uint32_t events_written = 0;
+    for (uint32_t event_index = 0; event_index < event_count; event_index++)
+    {
+        const TraceEvent *event = &trace_events[event_index];
+        if (!__atomic_load_n(&event->is_ready, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+        uint64_t relative_nanos = event->timestamp_nanos - origin_nanos;
+        fprintf(file, "%s{\"name\":", events_written > 0 ? ",\n" : "");
+        trace_write_json_string(file, event->name);
+        fprintf(file, ",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":1,\"tid\":%u}",
+                event->phase,
+                (unsigned long long)(relative_nanos / 1000),
+                (unsigned long long)(relative_nanos % 1000),
+                event->thread_id);
+        events_written++;
+    }
+    fprintf(file, "%s],\"otherData\":{\"dropped_events\":%u,\"unfinished_events\":%u}}\n", events_written > 0 ? "\n" : "",
+            trace_events_dropped, event_count - events_written);
+    fclose(file);
+
+    printf("Wrote %u trace events to %s (%u dropped)\n", events_written, trace_output_path, trace_events_dropped);
+    free(trace_events);
+    trace_events = NULL;
+    return 0;
+}
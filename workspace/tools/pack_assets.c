@@ -0,0 +1,178 @@
+#include "asset_pack.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Build step behind make asset_pack, decodes PNGs once so the device never has to.
+ *
+ *  pack_assets [--format=ARGB8888|ABGR8888|RGBA8888|BGRA8888] output.pack image.png...
+ *
+ * ARGB8888 is the default, it is the first texture format SDL's GLES2 and
+ * software renderers report. Other formats still load, the loader converts them.
+ */
+
+#define MAX_PACKED_IMAGES 64
+
+typedef struct
+{
+    const char *name;
+    Uint32 format;
+} PixelFormatName;
+
+static const PixelFormatName pixel_format_names[] = {
+    {"ARGB8888", SDL_PIXELFORMAT_ARGB8888},
+    {"ABGR8888", SDL_PIXELFORMAT_ABGR8888},
+    {"RGBA8888", SDL_PIXELFORMAT_RGBA8888},
+    {"BGRA8888", SDL_PIXELFORMAT_BGRA8888},
+};
+
+/* Same classification as get_surface_alpha_type in sdl_base.c, stored so the device doesn't rescan. */
+static ImageAlphaType get_alpha_type(const SDL_Surface *surface)
+{
+    Uint32 alpha_mask = surface->format->Amask;
+    bool has_transparent_pixels = false;
+    for (int row = 0; alpha_mask != 0 && row < surface->h; row++)
+    {
+        const Uint32 *pixels = (const Uint32 *)((const Uint8 *)surface->pixels + (size_t)row * surface->pitch);
+        for (int column = 0; column < surface->w; column++)
+        {
+            Uint32 alpha = pixels[column] & alpha_mask;
+            if (alpha != 0 && alpha != alpha_mask)
+            {
+                return IMAGE_ALPHA_BLENDED;
+            }
+            has_transparent_pixels = has_transparent_pixels || alpha == 0;
+        }
+    }
+    return has_transparent_pixels ? IMAGE_ALPHA_BINARY : IMAGE_ALPHA_OPAQUE;
+}
+
+static uint64_t align_to_page(uint64_t offset)
+{
+    return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+static int write_padding(FILE *file, uint64_t target_offset)
+{
+    long offset = ftell(file);
+    while (offset >= 0 && (uint64_t)offset < target_offset)
+    {
+        fputc(0, file);
+        offset++;
+    }
+    return offset < 0 ? 1 : 0;
+}
+
+static int print_usage(const char *program_name)
+{
+    fprintf(stderr, "Usage: %s [--format=ARGB8888|ABGR8888|RGBA8888|BGRA8888] output.pack image.png...\n", program_name);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    Uint32 pixel_format = SDL_PIXELFORMAT_ARGB8888;
+    int arg_index = 1;
+    if (arg_index < argc && strncmp(argv[arg_index], "--format=", strlen("--format=")) == 0)
+    {
+        const char *format_name = argv[arg_index] + strlen("--format=");
+        pixel_format = SDL_PIXELFORMAT_UNKNOWN;
+        for (size_t name_index = 0; name_index < sizeof(pixel_format_names) / sizeof(pixel_format_names[0]); name_index++)
+        {
+            if (strcmp(format_name, pixel_format_names[name_index].name) == 0)
+            {
+                pixel_format = pixel_format_names[name_index].format;
+            }
+        }
+        if (pixel_format == SDL_PIXELFORMAT_UNKNOWN)
+        {
+            return print_usage(argv[0]);
+        }
+        arg_index++;
+    }
+    if (argc - arg_index < 2 || argc - arg_index - 1 > MAX_PACKED_IMAGES)
+    {
+        return print_usage(argv[0]);
+    }
+
+    const char *output_path = argv[arg_index++];
+    int image_count = argc - arg_index;
+    static SDL_Surface *surfaces[MAX_PACKED_IMAGES];
+    static AssetPackEntry entries[MAX_PACKED_IMAGES];
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
+    {
+        fprintf(stderr, "SDL_image could not initialize! IMG_Error: %s\n", IMG_GetError());
+        return 1;
+    }
+
+    /* Decode and convert everything first so the index can be written up front. */
+    uint64_t offset = align_to_page(sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * image_count);
+    for (int image_index = 0; image_index < image_count; image_index++)
+    {
+        const char *image_path = argv[arg_index + image_index];
+        SDL_Surface *decoded = IMG_Load(image_path);
+        surfaces[image_index] = decoded != NULL ? SDL_ConvertSurfaceFormat(decoded, pixel_format, 0) : NULL;
+        SDL_FreeSurface(decoded);
+        if (surfaces[image_index] == NULL)
+        {
+            fprintf(stderr, "Unable to load %s: %s\n", image_path, SDL_GetError());
+            return 1;
+        }
+
+        const char *last_slash = strrchr(image_path, '/');
+        const char *image_name = last_slash != NULL ? last_slash + 1 : image_path;
+        AssetPackEntry *entry = &entries[image_index];
+        if (strlen(image_name) >= sizeof(entry->name))
+        {
+            fprintf(stderr, "Image name too long: %s\n", image_name);
+            return 1;
+        }
+        snprintf(entry->name, sizeof(entry->name), "%s", image_name);
+        entry->pixel_format = pixel_format;
+        entry->width = surfaces[image_index]->w;
+        entry->height = surfaces[image_index]->h;
+        entry->pitch = entry->width * SDL_BYTESPERPIXEL(pixel_format);
+        entry->alpha_type = get_alpha_type(surfaces[image_index]);
+        entry->offset = offset;
+        entry->size = (uint64_t)entry->pitch * entry->height;
+        offset = align_to_page(offset + entry->size);
+    }
+
+    FILE *file = fopen(output_path, "wb");
+    if (!file)
+    {
+        perror("fopen");
+        return 1;
+    }
+    AssetPackHeader header = {ASSET_PACK_MAGIC, ASSET_PACK_VERSION, (uint32_t)image_count, 0};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(entries, sizeof(AssetPackEntry), image_count, file);
+
+    /* Rows are written tightly packed, SDL surfaces may pad their pitch. */
+    for (int image_index = 0; image_index < image_count; image_index++)
+    {
+        const AssetPackEntry *entry = &entries[image_index];
+        const SDL_Surface *surface = surfaces[image_index];
+        write_padding(file, entry->offset);
+        for (uint32_t row = 0; row < entry->height; row++)
+        {
+            fwrite((const Uint8 *)surface->pixels + (size_t)row * surface->pitch, 1, entry->pitch, file);
+        }
+        static const char *alpha_type_names[] = {"opaque", "binary alpha", "blended alpha"};
+        printf("Packed %s: %ux%u %s, %llu bytes at offset %llu\n", entry->name, entry->width, entry->height, alpha_type_names[entry->alpha_type],
+               (unsigned long long)entry->size, (unsigned long long)entry->offset);
+        SDL_FreeSurface(surfaces[image_index]);
+    }
+
+    if (ferror(file) || fclose(file) != 0)
+    {
+        fprintf(stderr, "Failed to write %s\n", output_path);
+        return 1;
+    }
+    IMG_Quit();
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "sprite_atlas.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Build step behind make sprite_atlas, turns a sprite strip into a deduplicated tile atlas.
+ *
+ *  pack_sprite_atlas [--tile=N] [--atlas-width=N] sheet.png frame_width frame_height atlas.png atlas.index
+ *
+ * Frames are read left to right, top to bottom. Each frame is cut into
+ * tile x tile squares, fully transparent tiles are dropped and identical
+ * tiles (within a frame or across frames) are stored once.
+ */
+
+#define DEFAULT_TILE_SIZE 32
+#define DEFAULT_ATLAS_WIDTH 1024
+
+/* A tile of the source sheet, unique tiles also get an atlas position. */
+typedef struct
+{
+    int sheet_x;
+    int sheet_y;
+    int width;
+    int height;
+    uint64_t hash;
+} SheetTile;
+
+static uint64_t hash_tile(const SDL_Surface *sheet, const SheetTile *tile)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (int row = 0; row < tile->height; row++)
+    {
+        const Uint8 *pixels = (const Uint8 *)sheet->pixels + (size_t)(tile->sheet_y + row) * sheet->pitch + (size_t)tile->sheet_x * 4;
+        for (int byte = 0; byte < tile->width * 4; byte++)
+        {
+            hash ^= pixels[byte];
+            hash *= 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+static bool is_tile_transparent(const SDL_Surface *sheet, const SheetTile *tile)
+{
+    for (int row = 0; row < tile->height; row++)
+    {
+        const Uint32 *pixels = (const Uint32 *)((const Uint8 *)sheet->pixels + (size_t)(tile->sheet_y + row) * sheet->pitch) + tile->sheet_x;
+        for (int column = 0; column < tile->width; column++)
+        {
+            if ((pixels[column] & sheet->format->Amask) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool are_tiles_equal(const SDL_Surface *sheet, const SheetTile *first, const SheetTile *second)
+{
+    if (first->hash != second->hash || first->width != second->width || first->height != second->height)
+    {
+        return false;
+    }
+    for (int row = 0; row < first->height; row++)
+    {
+        const Uint8 *first_row = (const Uint8 *)sheet->pixels + (size_t)(first->sheet_y + row) * sheet->pitch + (size_t)first->sheet_x * 4;
+        const Uint8 *second_row = (const Uint8 *)sheet->pixels + (size_t)(second->sheet_y + row) * sheet->pitch + (size_t)second->sheet_x * 4;
+        if (memcmp(first_row, second_row, (size_t)first->width * 4) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int print_usage(const char *program_name)
+{
+    fprintf(stderr, "Usage: %s [--tile=N] [--atlas-width=N] sheet.png frame_width frame_height atlas.png atlas.index\n", program_name);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int tile_size = DEFAULT_TILE_SIZE;
+    int atlas_width = DEFAULT_ATLAS_WIDTH;
+    int arg_index = 1;
+    for (; arg_index < argc && strncmp(argv[arg_index], "--", 2) == 0; arg_index++)
+    {
+        if (strncmp(argv[arg_index], "--tile=", strlen("--tile=")) == 0)
+        {
+            tile_size = atoi(argv[arg_index] + strlen("--tile="));
+        }
+        else if (strncmp(argv[arg_index], "--atlas-width=", strlen("--atlas-width=")) == 0)
+        {
+            atlas_width = atoi(argv[arg_index] + strlen("--atlas-width="));
+        }
+        else
+        {
+            return print_usage(argv[0]);
+        }
+    }
+    if (argc - arg_index != 5 || tile_size <= 0 || atlas_width < tile_size)
+    {
+        return print_usage(argv[0]);
+    }
+    const char *sheet_path = argv[arg_index];
+    int frame_width = atoi(argv[arg_index + 1]);
+    int frame_height = atoi(argv[arg_index + 2]);
+    const char *atlas_path = argv[arg_index + 3];
+    const char *index_path = argv[arg_index + 4];
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
+    {
+        fprintf(stderr, "SDL_image could not initialize! IMG_Error: %s\n", IMG_GetError());
+        return 1;
+    }
+    SDL_Surface *decoded = IMG_Load(sheet_path);
+    SDL_Surface *sheet = decoded != NULL ? SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+    SDL_FreeSurface(decoded);
+    if (sheet == NULL)
+    {
+        fprintf(stderr, "Unable to load %s: %s\n", sheet_path, SDL_GetError());
+        return 1;
+    }
+    if (frame_width <= 0 || frame_height <= 0 || frame_width > UINT16_MAX || frame_height > UINT16_MAX ||
+        sheet->w % frame_width != 0 || sheet->h % frame_height != 0)
+    {
+        fprintf(stderr, "%dx%d frames don't divide the %dx%d sheet\n", frame_width, frame_height, sheet->w, sheet->h);
+        return 1;
+    }
+
+    int frames_per_row = sheet->w / frame_width;
+    int frame_count = frames_per_row * (sheet->h / frame_height);
+    int tiles_per_frame = ((frame_width + tile_size - 1) / tile_size) * ((frame_height + tile_size - 1) / tile_size);
+    SpriteAtlasFrame *frames = calloc(frame_count, sizeof(SpriteAtlasFrame));
+    SpriteAtlasPlacement *placements = calloc((size_t)frame_count * tiles_per_frame, sizeof(SpriteAtlasPlacement));
+    SheetTile *unique_tiles = calloc((size_t)frame_count * tiles_per_frame, sizeof(SheetTile));
+    if (!frames || !placements || !unique_tiles)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    int tiles_per_atlas_row = atlas_width / tile_size;
+    uint32_t placement_count = 0;
+    int unique_tile_count = 0;
+    for (int frame_index = 0; frame_index < frame_count; frame_index++)
+    {
+        int frame_x = (frame_index % frames_per_row) * frame_width;
+        int frame_y = (frame_index / frames_per_row) * frame_height;
+        frames[frame_index].first_placement = placement_count;
+        for (int tile_y = 0; tile_y < frame_height; tile_y += tile_size)
+        {
+            for (int tile_x = 0; tile_x < frame_width; tile_x += tile_size)
+            {
+                SheetTile tile = {frame_x + tile_x, frame_y + tile_y, SDL_min(tile_size, frame_width - tile_x),
+                                  SDL_min(tile_size, frame_height - tile_y), 0};
+                if (is_tile_transparent(sheet, &tile))
+                {
+                    continue;
+                }
+                tile.hash = hash_tile(sheet, &tile);
+
+                int unique_index = 0;
+                while (unique_index < unique_tile_count && !are_tiles_equal(sheet, &unique_tiles[unique_index], &tile))
+                {
+                    unique_index++;
+                }
+                if (unique_index == unique_tile_count)
+                {
+                    unique_tiles[unique_tile_count++] = tile;
+                }
+
+                placements[placement_count++] = (SpriteAtlasPlacement){
+                    (uint16_t)((unique_index % tiles_per_atlas_row) * tile_size), (uint16_t)((unique_index / tiles_per_atlas_row) * tile_size),
+                    (uint16_t)tile_x, (uint16_t)tile_y, (uint16_t)tile.width, (uint16_t)tile.height};
+            }
+        }
+        frames[frame_index].placement_count = placement_count - frames[frame_index].first_placement;
+    }
+
+    /* Copy each unique tile to its atlas slot, unused space stays transparent. */
+    int atlas_height = SDL_max(1, (unique_tile_count + tiles_per_atlas_row - 1) / tiles_per_atlas_row) * tile_size;
+    if (atlas_height > UINT16_MAX)
+    {
+        fprintf(stderr, "Atlas would be %d pixels tall, use a wider atlas\n", atlas_height);
+        return 1;
+    }
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, atlas_width, atlas_height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas == NULL)
+    {
+        fprintf(stderr, "Unable to create the atlas surface: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_SetSurfaceBlendMode(sheet, SDL_BLENDMODE_NONE);
+    for (int unique_index = 0; unique_index < unique_tile_count; unique_index++)
+    {
+        const SheetTile *tile = &unique_tiles[unique_index];
+        SDL_Rect source = {tile->sheet_x, tile->sheet_y, tile->width, tile->height};
+        SDL_Rect destination = {(unique_index % tiles_per_atlas_row) * tile_size, (unique_index / tiles_per_atlas_row) * tile_size,
+                                tile->width, tile->height};
+        SDL_BlitSurface(sheet, &source, atlas, &destination);
+    }
+    if (IMG_SavePNG(atlas, atlas_path) != 0)
+    {
+        fprintf(stderr, "Unable to save %s: %s\n", atlas_path, IMG_GetError());
+        return 1;
+    }
+
+    FILE *file = fopen(index_path, "wb");
+    if (!file)
+    {
+        perror("fopen");
+        return 1;
+    }
+    SpriteAtlasHeader header = {SPRITE_ATLAS_MAGIC, SPRITE_ATLAS_VERSION, (uint16_t)frame_width, (uint16_t)frame_height,
+                                (uint32_t)frame_count, placement_count};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(frames, sizeof(SpriteAtlasFrame), frame_count, file);
+    fwrite(placements, sizeof(SpriteAtlasPlacement), placement_count, file);
+    if (ferror(file) || fclose(file) != 0)
+    {
+        fprintf(stderr, "Failed to write %s\n", index_path);
+        return 1;
+    }
+
+    printf("Packed %d frames into %d unique %dpx tiles (%u placements): %dx%d atlas, %d KiB of pixels instead of %d KiB\n",
+           frame_count, unique_tile_count, tile_size, placement_count, atlas_width, atlas_height,
+           atlas_width * atlas_height * 4 / 1024, sheet->w * sheet->h * 4 / 1024);
+
+    SDL_FreeSurface(atlas);
+    SDL_FreeSurface(sheet);
+    free(unique_tiles);
+    free(placements);
+    free(frames);
+    IMG_Quit();
+    return 0;
+}